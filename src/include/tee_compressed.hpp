@@ -0,0 +1,91 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/bitpacking.hpp"
+#include "duckdb/common/column_data_collection_render_interface.hpp"
+
+namespace duckdb {
+
+enum class TeeSegmentEncoding : uint8_t { PLAIN, CONSTANT, RLE, DICTIONARY };
+
+// One column of one captured chunk, its memory comes from the buffer allocator
+struct TeeCompressedSegment {
+	TeeSegmentEncoding encoding = TeeSegmentEncoding::PLAIN;
+	// every row (plain), the single value (constant), one value per run (rle) or the distinct values (dictionary)
+	unique_ptr<Vector> values;
+	// the fixed-size values followed by the strings they point to
+	AllocatedData storage;
+	// rle: uint16_t end of every run, dictionary: bit-packed indices into values
+	AllocatedData encoded;
+	idx_t value_count = 0;
+	bitpacking_width_t bit_width = 0;
+
+	// points result at values without copying them, as a constant or dictionary vector
+	void Decode(Vector &result, idx_t count) const;
+};
+
+struct TeeCompressedChunk {
+	idx_t count;
+	vector<TeeCompressedSegment> columns;
+};
+
+// Capture buffer that encodes every column segment as it is appended. Chunks are only
+// decoded when the renderer fetches them, which is at most the first and the last one.
+class TeeCompressedBuffer {
+public:
+	TeeCompressedBuffer(ClientContext &context, vector<LogicalType> types);
+
+	// nested columns are captured uncompressed
+	static bool SupportsTypes(const vector<LogicalType> &types);
+
+	void Append(DataChunk &chunk);
+	// moves the chunks of other into this buffer
+	void Combine(TeeCompressedBuffer &other);
+	void Reset();
+	idx_t Count() const {
+		return count;
+	}
+	idx_t ChunkCount() const {
+		return chunks.size();
+	}
+	const vector<LogicalType> &Types() const {
+		return types;
+	}
+
+	// the decoded vectors reference the buffer, it has to outlive result
+	void FetchChunk(idx_t chunk_idx, DataChunk &result) const;
+
+private:
+	Allocator &allocator;
+	vector<LogicalType> types;
+	vector<TeeCompressedChunk> chunks;
+	idx_t count = 0;
+};
+
+// Lets the BoxRenderer read a compressed buffer like ColumnDataCollectionWrapper reads a collection
+class TeeCompressedRenderWrapper : public ColumnDataRenderInterface {
+public:
+	explicit TeeCompressedRenderWrapper(const TeeCompressedBuffer &buffer) : buffer(buffer) {
+	}
+
+	const vector<LogicalType> &Types() const override {
+		return buffer.Types();
+	}
+	idx_t ColumnCount() const override {
+		return buffer.Types().size();
+	}
+	idx_t Count() const override {
+		return buffer.Count();
+	}
+	idx_t ChunkCount() const override {
+		return buffer.ChunkCount();
+	}
+	void FetchChunk(idx_t chunk_idx, DataChunk &result) const override {
+		buffer.FetchChunk(chunk_idx, result);
+	}
+
+private:
+	const TeeCompressedBuffer &buffer;
+};
+
+} // namespace duckdb
@@ -1,8 +1,16 @@
 #pragma once
 
 #include "duckdb.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/string_util.hpp"
 #include "duckdb/common/types/column/column_data_collection.hpp"
 #include "duckdb/execution/physical_operator_states.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+#include "tee_compressed.hpp"
+#include "tee_fingerprint.hpp"
+#include "tee_group_commit.hpp"
+#include "tee_native.hpp"
+#include "tee_ndjson.hpp"
 
 namespace duckdb {
 
@@ -28,6 +36,42 @@ struct TeeOptions {
 			table_name_flag = true;
 			table_name = params.at("table_name").GetValue<string>();
 		}
+		if (params.find("format") != params.end()) {
+			if (!path_flag) {
+				throw InvalidInputException("Tee: format can only be used together with path");
+			}
+			format = StringUtil::Lower(params.at("format").GetValue<string>());
+			if (format != "csv" && format != "native" && format != "ndjson") {
+				throw InvalidInputException("Tee: unknown format '%s', expected 'csv', 'native' or 'ndjson'", format);
+			}
+		}
+		if (params.find("fingerprint") != params.end()) {
+			fingerprint_flag = params.at("fingerprint").GetValue<bool>();
+			if (fingerprint_flag && path_flag) {
+				throw InvalidInputException("Tee: fingerprint cannot be combined with path");
+			}
+		}
+		if (params.find("mode") != params.end()) {
+			// table_name rows always join the table, there is nothing to overwrite or keep open
+			if (!path_flag) {
+				throw InvalidInputException("Tee: mode can only be used together with path");
+			}
+			auto mode = StringUtil::Lower(params.at("mode").GetValue<string>());
+			if (mode == "append") {
+				append_flag = true;
+			} else if (mode != "overwrite") {
+				throw InvalidInputException("Tee: unknown mode '%s', expected 'overwrite' or 'append'", mode);
+			}
+		}
+		if (params.find("group_commit") != params.end()) {
+			group_commit_flag = params.at("group_commit").GetValue<bool>();
+			if (group_commit_flag && !table_name_flag) {
+				throw InvalidInputException("Tee: group_commit can only be used together with table_name");
+			}
+		}
+		if (params.find("compress") != params.end()) {
+			compress_flag = params.at("compress").GetValue<bool>();
+		}
 		if (params.find("maxrows") != params.end()) {
 			auto rows = params.at("maxrows").GetValue<int64_t>();
 			if (rows < 0) {
@@ -42,12 +86,21 @@ struct TeeOptions {
 		}
 	}
 
+	// a fingerprint replaces the captured rows in every sink
 	bool NeedsBuffer() const {
-		return terminal_flag || pager_flag;
+		return !fingerprint_flag && (terminal_flag || pager_flag);
 	}
 
 	bool NeedsStream() const {
-		return path_flag || table_name_flag;
+		return !fingerprint_flag && (path_flag || table_name_flag);
+	}
+
+	bool IsNativeFormat() const {
+		return path_flag && format == "native";
+	}
+
+	bool IsNDJSONFormat() const {
+		return path_flag && format == "ndjson";
 	}
 
 	// named parameters
@@ -57,13 +110,162 @@ struct TeeOptions {
 	string symbol;
 	bool path_flag = false;
 	string path;
+	// file format of path, csv, native or ndjson
+	string format = "csv";
 	bool table_name_flag = false;
 	string table_name;
+	// append to the files and keep them open across queries
+	bool append_flag = false;
+	// commit table_name rows together with other queries instead of in the own transaction
+	bool group_commit_flag = false;
+	bool fingerprint_flag = false;
+	// keep the captured rows encoded until they are rendered
+	bool compress_flag = false;
 	// same default as DuckDB
 	idx_t max_rows = 40;
 };
 
 class TeeLocalState;
+class TableCatalogEntry;
+class BoundConstraint;
+struct LocalAppendState;
+
+// Target of the path or table_name sink. Opened per query, or cached by the
+// connection in append mode and only closed when idle or with the connection.
+class TeeSink {
+public:
+	TeeSink(const vector<string> &names, const vector<LogicalType> &types) : names(names), types(types) {
+	}
+	virtual ~TeeSink() = default;
+
+	virtual void WriteChunk(ClientContext &context, DataChunk &chunk, TeeLocalState &l_state) = 0;
+	// makes everything written so far visible to readers of the target
+	virtual void Flush() = 0;
+	virtual void Close() = 0;
+
+	// a cached sink is only reused for the same schema
+	bool Matches(const vector<string> &other_names, const vector<LogicalType> &other_types) const {
+		return names == other_names && types == other_types;
+	}
+
+	template <class TARGET>
+	TARGET &Cast() {
+		DynamicCastCheck<TARGET>(this);
+		return reinterpret_cast<TARGET &>(*this);
+	}
+
+protected:
+	vector<string> names;
+	vector<LogicalType> types;
+};
+
+class TeeFileSink : public TeeSink {
+public:
+	TeeFileSink(ClientContext &context, const TeeOptions &options, const vector<string> &names,
+	            const vector<LogicalType> &types);
+
+	void WriteChunk(ClientContext &context, DataChunk &chunk, TeeLocalState &l_state) override;
+	void Flush() override;
+	void Close() override;
+	// another connection overwrote the file this sink appends to
+	bool IsStale() const {
+		return native_writer && native_writer->IsInvalidated();
+	}
+
+private:
+	unique_ptr<FileHandle> csv_handle;
+	unique_ptr<WriteStream> csv_stream;
+	unique_ptr<CSVWriter> csv_writer;
+	// shared with the other connections of the database in append mode, closed by its last user
+	shared_ptr<TeeNativeWriter> native_writer;
+	bool shared_native_writer = false;
+	unique_ptr<TeeNDJSONWriter> ndjson_writer;
+
+	void TeeInitializeCSVWriter(ClientContext &context, const TeeOptions &options);
+};
+
+// Creates the table through the catalog and appends into the local storage of the
+// running transaction, so the rows commit or roll back together with the query
+class TeeTableSink : public TeeSink {
+public:
+	TeeTableSink(ClientContext &context, const QualifiedName &table_name, const vector<string> &names,
+	             const vector<LogicalType> &types);
+	~TeeTableSink() override;
+
+	// parses table_name, a schema that names an attached database becomes the catalog
+	static QualifiedName BindName(ClientContext &context, const string &table_name);
+	// creates the table unless it exists, an existing table has to be a DuckDB table
+	static TableCatalogEntry &CreateTable(ClientContext &context, const QualifiedName &table_name,
+	                                      const vector<string> &names, const vector<LogicalType> &types);
+
+	void WriteChunk(ClientContext &context, DataChunk &chunk, TeeLocalState &l_state) override;
+	void AppendChunk(DataChunk &chunk);
+	// finalizes the local append, has to happen before the transaction commits
+	void Flush() override;
+	// QueryEnd runs after the commit, an append that was not flushed belongs to a failed query
+	void Close() override;
+
+private:
+	ClientContext &context;
+	optional_ptr<TableCatalogEntry> table;
+	vector<unique_ptr<BoundConstraint>> bound_constraints;
+	unique_ptr<LocalAppendState> append_state;
+	// only used when an existing table has different column types
+	vector<LogicalType> table_types;
+	DataChunk cast_chunk;
+	mutex append_lock;
+};
+
+// Collects the rows of one query and hands them to the group commit writer of the table in
+// Flush, which returns once they are committed. They do not belong to the query's transaction.
+class TeeGroupCommitSink : public TeeSink {
+public:
+	TeeGroupCommitSink(ClientContext &context, const TeeOptions &options, const vector<string> &names,
+	                   const vector<LogicalType> &types);
+
+	void WriteChunk(ClientContext &context, DataChunk &chunk, TeeLocalState &l_state) override;
+	void AppendChunk(DataChunk &chunk);
+	void Flush() override;
+	// rows of a query that failed before Flush are dropped
+	void Close() override;
+
+private:
+	shared_ptr<TeeGroupCommitWriter> writer;
+	unique_ptr<ColumnDataCollection> rows;
+	mutex rows_lock;
+	// tee_group_commit_max_rows and tee_group_commit_max_wait_ms
+	idx_t max_rows;
+	std::chrono::milliseconds max_wait;
+};
+
+// Append-mode file sinks of one connection, keyed by their path.
+// Table sinks are bound to a transaction and never cached.
+class TeeSinkCache : public ClientContextState {
+public:
+	static constexpr const char *KEY = "tee_sink_cache";
+
+	~TeeSinkCache() override;
+
+	shared_ptr<TeeSink> GetFileSink(ClientContext &context, const TeeOptions &options, const vector<string> &names,
+	                                const vector<LogicalType> &types);
+	// drops the sink of a path that is about to be overwritten
+	void Evict(const string &path);
+	// Closes the sinks that were not used for longer than tee_sink_idle_timeout
+	void QueryEnd(ClientContext &context, optional_ptr<ErrorData> error) override;
+
+private:
+	struct CachedSink {
+		shared_ptr<TeeSink> sink;
+		string format;
+		time_t last_used;
+	};
+
+	mutex cache_lock;
+	unordered_map<string, CachedSink> sinks;
+
+	// expects cache_lock to be held
+	void CloseIdle(ClientContext &context);
+};
 
 class TeeGlobalState : public ClientContextState {
 public:
@@ -80,21 +282,35 @@ public:
 		buffered->Combine(local_buffer);
 	}
 
+	void AppendLocalToGlobalCompressed(TeeCompressedBuffer &local_compressed) {
+		lock_guard<mutex> guard(buffer_lock);
+		compressed->Combine(local_compressed);
+	}
+
+	void CombineFingerprint(const TeeFingerprint &local_fingerprint) {
+		lock_guard<mutex> guard(buffer_lock);
+		fingerprint->Combine(local_fingerprint);
+	}
+
+	void WriteFingerprint(const vector<string> &names);
+
 	// only set when we buffer, read by OperatorFinalize
 	unique_ptr<ColumnDataCollection> buffered;
+	// replaces buffered with compress, rendered by OperatorFinalize without decompressing it
+	unique_ptr<TeeCompressedBuffer> compressed;
+	// only set in fingerprint mode, read by OperatorFinalize
+	unique_ptr<TeeFingerprint> fingerprint;
 
 private:
 	mutex buffer_lock;
-	unique_ptr<CSVWriter> csv_writer;
-	unique_ptr<Connection> con;
-	unique_ptr<Appender> appender;
-	mutex appender_lock;
+	shared_ptr<TeeSink> file_sink;
+	shared_ptr<TeeSink> table_sink;
+	// cached file sinks are only flushed in QueryEnd, the cache closes them
+	bool cached_sinks;
+	// table_sink is a TeeGroupCommitSink instead of a TeeTableSink
+	bool group_commit;
 	// key we need to unregister the state in QueryEnd
 	string key;
-
-	void TeeInitializeCSVWriter(ClientContext &context, const TeeOptions &options, const vector<string> &names);
-	void TeeInitializeTableWriter(ClientContext &context, const TeeOptions &options, const vector<string> &names,
-	                              const vector<LogicalType> &types);
 };
 
 //!! State of a single thread
@@ -106,8 +322,11 @@ public:
 	shared_ptr<TeeGlobalState> global_state;
 	unique_ptr<ColumnDataCollection> local_buffer;
 	ColumnDataAppendState local_append_state;
+	unique_ptr<TeeCompressedBuffer> local_compressed;
 	unique_ptr<CSVWriterState> local_csv_state;
 	DataChunk varchar_chunk_csv;
+	unique_ptr<MemoryStream> local_native_stream;
+	unique_ptr<TeeFingerprint> local_fingerprint;
 
 	void Finalize(const PhysicalOperator &op, ExecutionContext &context) override;
 
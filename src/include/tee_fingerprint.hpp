@@ -0,0 +1,36 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+// Order-independent summary of every row that went through a tee.
+// Row and column hashes are summed, so equal multisets of rows give equal fingerprints.
+class TeeFingerprint {
+public:
+	explicit TeeFingerprint(idx_t column_count);
+
+	idx_t row_count = 0;
+	hash_t row_hash = 0;
+	vector<hash_t> column_hashes;
+
+	void Update(DataChunk &chunk);
+	void Combine(const TeeFingerprint &other);
+	void Reset();
+	string ToString(const vector<string> &names) const;
+
+	// schema of the table written with table_name, one row for the whole row plus one per column
+	static vector<string> TableNames();
+	static vector<LogicalType> TableTypes();
+	idx_t TableRowCount() const {
+		return column_hashes.size() + 1;
+	}
+	// fills result with at most STANDARD_VECTOR_SIZE table rows, starting at row offset
+	void ToChunk(const vector<string> &names, idx_t offset, DataChunk &result) const;
+
+private:
+	Vector hashes;
+	unsafe_unique_array<hash_t> row_hashes;
+};
+
+} // namespace duckdb
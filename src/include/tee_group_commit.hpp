@@ -0,0 +1,66 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/error_data.hpp"
+#include "duckdb/common/optional_idx.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+#include "duckdb/storage/object_cache.hpp"
+
+#include <chrono>
+#include <condition_variable>
+
+namespace duckdb {
+
+// Rows of the queries that are committed together
+struct TeeCommitGroup {
+	vector<vector<string>> names;
+	vector<unique_ptr<ColumnDataCollection>> rows;
+	idx_t row_count = 0;
+	bool committed = false;
+	// per query, read by the query once committed is set
+	vector<ErrorData> errors;
+};
+
+// One writer per fully qualified table and database, shared by every query that tees into it
+// with group_commit. The rows of concurrent queries are collected into one group and appended
+// and committed together, once enough rows are pending or a waiting query runs out of time.
+// It lives in the object cache of the database, so it only keeps a reference to the database
+// and opens a connection per group instead of holding one.
+class TeeGroupCommitWriter : public ObjectCacheEntry {
+public:
+	TeeGroupCommitWriter(DatabaseInstance &db, const QualifiedName &table_name);
+
+	static shared_ptr<TeeGroupCommitWriter> Get(ClientContext &context, const QualifiedName &table_name);
+
+	static string ObjectType() {
+		return "tee_group_commit_writer";
+	}
+	string GetObjectType() override {
+		return ObjectType();
+	}
+	// unknown, so the cache never evicts a writer while queries wait on its groups
+	optional_idx GetEstimatedCacheMemory() const override {
+		return optional_idx();
+	}
+
+	// Adds the rows to the open group and returns once that group is committed. A query that
+	// waited max_wait, or whose rows filled the group to max_rows, commits the group itself.
+	void Commit(const vector<string> &names, unique_ptr<ColumnDataCollection> rows, idx_t max_rows,
+	            std::chrono::milliseconds max_wait);
+
+private:
+	DatabaseInstance &db;
+	QualifiedName table_name;
+
+	mutex lock;
+	std::condition_variable group_committed;
+	// the group new rows join, it is swapped for an empty one when it is committed
+	shared_ptr<TeeCommitGroup> open_group;
+	bool committing = false;
+
+	void CommitGroup(unique_lock<mutex> &guard);
+	void AppendQuery(ClientContext &context, TeeCommitGroup &group, idx_t query_idx);
+};
+
+} // namespace duckdb
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/optional_idx.hpp"
+#include "duckdb/common/serializer/memory_stream.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/storage/object_cache.hpp"
+
+namespace duckdb {
+
+// Layout of a native tee snapshot, host byte order, every section starts 64 byte aligned:
+//   header  | magic, version
+//   chunks  | per column: validity bitmap, then the fixed-width values
+//           | or uint64 offsets[count + 1] followed by the string heap
+//   footer  | column names and types, (offset, count) of the chunks since the previous footer,
+//           | offset of the previous footer or 0 and where its trailer ends
+//   trailer | footer offset, magic
+// Every flush adds chunks and one footer with trailer, so the file always ends in a trailer
+// and readers follow the footers back to the first one, reading only the footers.
+struct TeeNativeFormat {
+	static constexpr const char *MAGIC = "TEENATV1";
+	static constexpr idx_t MAGIC_SIZE = 8;
+	static constexpr uint32_t VERSION = 2;
+	static constexpr idx_t ALIGNMENT = 64;
+	static constexpr idx_t HEADER_SIZE = 64;
+	static constexpr idx_t TRAILER_SIZE = sizeof(uint64_t) + MAGIC_SIZE;
+
+	static idx_t Align(idx_t size) {
+		return AlignValue<idx_t, ALIGNMENT>(size);
+	}
+	static bool SupportsType(const LogicalType &type);
+	static bool IsStringType(const LogicalType &type) {
+		return type.InternalType() == PhysicalType::VARCHAR;
+	}
+};
+
+struct TeeNativeChunkEntry {
+	uint64_t offset;
+	uint64_t count;
+};
+
+// Appends DataChunks to a native snapshot. Flush and Close write a footer that only lists
+// the chunks since the previous one, so flushing costs the same however old the file is.
+class TeeNativeWriter {
+public:
+	TeeNativeWriter(ClientContext &context, const string &path, const vector<string> &names,
+	                const vector<LogicalType> &types, bool append);
+	// the last connection that appended through a shared writer lets go of it here
+	~TeeNativeWriter();
+
+	// serializes into the thread-local stream first, only the file write holds the lock
+	void WriteChunk(DataChunk &chunk, MemoryStream &local_stream);
+	void Flush();
+	void Close();
+	// the file was overwritten, later chunks would land at offsets of the old file
+	void Invalidate();
+	bool IsInvalidated();
+	bool Matches(const vector<string> &other_names, const vector<LogicalType> &other_types) const {
+		return names == other_names && types == other_types;
+	}
+
+private:
+	string path;
+	unique_ptr<FileHandle> handle;
+	bool invalidated = false;
+	vector<string> names;
+	vector<LogicalType> types;
+	// written since the last footer
+	vector<TeeNativeChunkEntry> chunks;
+	idx_t file_offset;
+	// 0 until the first footer is written
+	idx_t previous_footer;
+	idx_t previous_footer_end;
+	mutex write_lock;
+
+	void SerializeChunk(DataChunk &chunk, MemoryStream &stream) const;
+	void WriteFooter();
+};
+
+// Native append writers of one database, keyed by path. Every connection that appends to a
+// path writes through the same writer, so the offsets and footers it keeps match the file.
+class TeeNativeAppendWriters : public ObjectCacheEntry {
+public:
+	static shared_ptr<TeeNativeAppendWriters> Get(ClientContext &context);
+
+	static string ObjectType() {
+		return "tee_native_append_writers";
+	}
+	string GetObjectType() override {
+		return ObjectType();
+	}
+	// unknown, so the cache never forgets writers that connections still append through
+	optional_idx GetEstimatedCacheMemory() const override {
+		return optional_idx();
+	}
+
+	// the open writer of path, or a new one that continues the file
+	shared_ptr<TeeNativeWriter> GetWriter(ClientContext &context, const string &path, const vector<string> &names,
+	                                      const vector<LogicalType> &types);
+	// called before path is overwritten
+	void Invalidate(ClientContext &context, const string &path);
+
+private:
+	mutex lock;
+	// writers are closed by their last user, the entry then expires
+	unordered_map<string, weak_ptr<TeeNativeWriter>> writers;
+};
+
+// A native snapshot, scanned vectors point directly into it. Local files are mapped into memory,
+// other files only have their footers read when opened and every chunk read when it is scanned.
+class TeeNativeFile {
+public:
+	explicit TeeNativeFile(Allocator &allocator) : allocator(allocator) {
+	}
+	~TeeNativeFile();
+
+	static shared_ptr<TeeNativeFile> Open(ClientContext &context, const string &path);
+
+	vector<string> names;
+	vector<LogicalType> types;
+	vector<TeeNativeChunkEntry> chunks;
+	// where the last footer starts
+	idx_t footer_offset = 0;
+
+	// keep_alive is attached to every output vector of a mapped file so the mapping outlives them
+	void ScanChunk(idx_t chunk_idx, DataChunk &output, const buffer_ptr<VectorBuffer> &keep_alive) const;
+
+private:
+	Allocator &allocator;
+	idx_t size = 0;
+	data_ptr_t data = nullptr;
+	bool mapped = false;
+	// read from when the file is not mapped
+	unique_ptr<FileHandle> handle;
+	mutable mutex read_lock;
+	// per chunk, where the next chunk or the footer that lists it starts
+	vector<idx_t> chunk_ends;
+
+	void MapFile(const string &path);
+	void ReadFooter(const string &path);
+	// length bytes at offset, in the mapping or read into buffer
+	data_ptr_t ReadRange(idx_t offset, idx_t length, AllocatedData &buffer) const;
+};
+
+// tee_read('file') scans a snapshot written with format := 'native'
+struct TeeReadFunction {
+	static TableFunction GetFunction();
+};
+
+} // namespace duckdb
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/serializer/memory_stream.hpp"
+
+namespace duckdb {
+
+struct TeeJSONField;
+
+// Writes one valid value at idx of the unified format, NULLs are handled by the caller
+typedef void (*tee_json_write_t)(MemoryStream &stream, const TeeJSONField &field,
+                                 const RecursiveUnifiedVectorFormat &format, idx_t idx);
+
+// How one column or nested child is written, built once from the bound types
+struct TeeJSONField {
+	// type after the cast that turns every leaf into a bool, integer or string
+	LogicalType cast_type;
+	// picked once per field, so encoding a value does not look at its type again
+	tee_json_write_t write = nullptr;
+	// struct children and the columns of the row: ,"name": with the name already escaped
+	vector<string> keys;
+	vector<TeeJSONField> children;
+};
+
+// Writes JSON Lines, one object per row, encoded directly from the vectors
+class TeeNDJSONWriter {
+public:
+	TeeNDJSONWriter(ClientContext &context, const string &path, const vector<string> &names,
+	                const vector<LogicalType> &types, bool append);
+
+	// encodes into the thread-local stream first, only the file write holds the lock
+	void WriteChunk(ClientContext &context, DataChunk &chunk, MemoryStream &local_stream);
+	void Close();
+
+private:
+	unique_ptr<FileHandle> handle;
+	TeeJSONField row;
+	mutex write_lock;
+};
+
+} // namespace duckdb
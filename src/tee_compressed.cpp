@@ -0,0 +1,330 @@
+#include "include/tee_compressed.hpp"
+#include "duckdb/common/types/hash.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+
+namespace duckdb {
+
+// Runs and dictionary entries are found by comparing the bytes of the values, not with SQL equality,
+// which treats values such as 0.0 and -0.0 or INTERVAL '1 month' and '30 days' as equal
+template <class T>
+static bool TeeBytesEqual(const T &left, const T &right) {
+	return memcmp(&left, &right, sizeof(T)) == 0;
+}
+
+template <>
+bool TeeBytesEqual(const string_t &left, const string_t &right) {
+	return left.GetSize() == right.GetSize() && memcmp(left.GetData(), right.GetData(), left.GetSize()) == 0;
+}
+
+template <class T>
+static hash_t TeeBytesHash(const T &value) {
+	return Hash(const_char_ptr_cast(&value), sizeof(T));
+}
+
+template <>
+hash_t TeeBytesHash(const string_t &value) {
+	return Hash(value.GetData(), value.GetSize());
+}
+
+struct TeeValueHash {
+	template <class T>
+	size_t operator()(const T &value) const {
+		return TeeBytesHash<T>(value);
+	}
+};
+
+struct TeeValueEquals {
+	template <class T>
+	bool operator()(const T &left, const T &right) const {
+		return TeeBytesEqual<T>(left, right);
+	}
+};
+
+// Copies the rows of input picked by sel into memory of the buffer allocator, strings included,
+// so the segment owns its values and they count against the memory limit
+static void TeeCopyValues(Allocator &allocator, Vector &input, idx_t count, const SelectionVector &sel,
+                          idx_t value_count, TeeCompressedSegment &segment) {
+	auto &type = input.GetType();
+	auto is_string = type.InternalType() == PhysicalType::VARCHAR;
+	auto width = GetTypeIdSize(type.InternalType());
+	UnifiedVectorFormat format;
+	input.ToUnifiedFormat(count, format);
+	auto strings = UnifiedVectorFormat::GetData<string_t>(format);
+
+	idx_t heap_size = 0;
+	for (idx_t i = 0; is_string && i < value_count; i++) {
+		auto idx = format.sel->get_index(sel.get_index(i));
+		if (format.validity.RowIsValid(idx) && !strings[idx].IsInlined()) {
+			heap_size += strings[idx].GetSize();
+		}
+	}
+	auto fixed_size = value_count * width;
+	segment.storage = allocator.Allocate(MaxValue<idx_t>(fixed_size + heap_size, 1));
+	auto data = segment.storage.get();
+	auto heap = data + fixed_size;
+	segment.values = make_uniq<Vector>(type, data);
+	segment.value_count = value_count;
+
+	auto &validity = FlatVector::Validity(*segment.values);
+	for (idx_t i = 0; i < value_count; i++) {
+		auto idx = format.sel->get_index(sel.get_index(i));
+		if (!format.validity.RowIsValid(idx)) {
+			validity.SetInvalid(i);
+			continue;
+		}
+		if (!is_string) {
+			memcpy(data + i * width, format.data + idx * width, width);
+			continue;
+		}
+		auto &source = strings[idx];
+		auto target = reinterpret_cast<string_t *>(data) + i;
+		if (source.IsInlined()) {
+			*target = source;
+			continue;
+		}
+		memcpy(heap, source.GetData(), source.GetSize());
+		*target = string_t(const_char_ptr_cast(heap), UnsafeNumericCast<uint32_t>(source.GetSize()));
+		heap += source.GetSize();
+	}
+}
+
+static void TeeEncodePlain(Allocator &allocator, Vector &input, idx_t count, TeeCompressedSegment &segment) {
+	segment.encoding = TeeSegmentEncoding::PLAIN;
+	TeeCopyValues(allocator, input, count, *FlatVector::IncrementalSelectionVector(), count, segment);
+}
+
+static void TeeEncodeConstant(Allocator &allocator, Vector &input, idx_t count, TeeCompressedSegment &segment) {
+	segment.encoding = TeeSegmentEncoding::CONSTANT;
+	SelectionVector first(1);
+	first.set_index(0, 0);
+	TeeCopyValues(allocator, input, count, first, 1, segment);
+}
+
+template <class T>
+static bool TeeRowEquals(const UnifiedVectorFormat &format, const T *data, idx_t left, idx_t right) {
+	auto left_idx = format.sel->get_index(left);
+	auto right_idx = format.sel->get_index(right);
+	auto left_valid = format.validity.RowIsValid(left_idx);
+	auto right_valid = format.validity.RowIsValid(right_idx);
+	if (!left_valid || !right_valid) {
+		return left_valid == right_valid;
+	}
+	return TeeBytesEqual<T>(data[left_idx], data[right_idx]);
+}
+
+// Picks the smallest of plain, rle and dictionary for one column segment.
+// Sizes are estimated from the fixed part of the values, string heaps shrink along with them.
+template <class T>
+static void TeeEncodeSegment(Allocator &allocator, Vector &input, idx_t count, TeeCompressedSegment &segment) {
+	UnifiedVectorFormat format;
+	input.ToUnifiedFormat(count, format);
+	auto data = UnifiedVectorFormat::GetData<T>(format);
+
+	auto plain_size = count * sizeof(T);
+	SelectionVector run_starts(count);
+	auto run_ends = make_unsafe_uniq_array<uint16_t>(count);
+	auto run_end_data = run_ends.get();
+	idx_t run_count = 0;
+	for (idx_t row = 0; row < count; row++) {
+		if (row == 0 || !TeeRowEquals<T>(format, data, row - 1, row)) {
+			if (run_count > 0) {
+				run_end_data[run_count - 1] = UnsafeNumericCast<uint16_t>(row);
+			}
+			run_starts.set_index(run_count++, row);
+		}
+	}
+	run_end_data[run_count - 1] = UnsafeNumericCast<uint16_t>(count);
+	if (run_count == 1) {
+		TeeEncodeConstant(allocator, input, count, segment);
+		return;
+	}
+	auto rle_size = run_count * (sizeof(T) + sizeof(uint16_t));
+
+	// dictionary, given up as soon as it cannot beat the better of plain and rle
+	auto best_size = MinValue(plain_size, rle_size);
+	auto padded_count = AlignValue<idx_t, BitpackingPrimitives::BITPACKING_ALGORITHM_GROUP_SIZE>(count);
+	auto indices = make_unsafe_uniq_array<uint32_t>(padded_count);
+	memset(indices.get(), 0, padded_count * sizeof(uint32_t));
+	unordered_map<T, uint32_t, TeeValueHash, TeeValueEquals> dictionary;
+	SelectionVector dictionary_rows(count);
+	idx_t dictionary_size = 0;
+	idx_t null_index = DConstants::INVALID_INDEX;
+	bool use_dictionary = true;
+	for (idx_t row = 0; row < count; row++) {
+		auto idx = format.sel->get_index(row);
+		uint32_t index;
+		if (!format.validity.RowIsValid(idx)) {
+			if (null_index == DConstants::INVALID_INDEX) {
+				null_index = dictionary_size;
+				dictionary_rows.set_index(dictionary_size++, row);
+			}
+			index = UnsafeNumericCast<uint32_t>(null_index);
+		} else {
+			auto entry = dictionary.find(data[idx]);
+			if (entry == dictionary.end()) {
+				index = UnsafeNumericCast<uint32_t>(dictionary_size);
+				dictionary.emplace(data[idx], index);
+				dictionary_rows.set_index(dictionary_size++, row);
+			} else {
+				index = entry->second;
+			}
+		}
+		indices[row] = index;
+		if (dictionary_size * sizeof(T) >= best_size) {
+			use_dictionary = false;
+			break;
+		}
+	}
+	if (use_dictionary) {
+		auto max_index = UnsafeNumericCast<uint32_t>(dictionary_size - 1);
+		auto bit_width = BitpackingPrimitives::MinimumBitWidth<uint32_t>(max_index);
+		auto packed_size = BitpackingPrimitives::GetRequiredSize(padded_count, bit_width);
+		if (dictionary_size * sizeof(T) + packed_size < best_size) {
+			segment.encoding = TeeSegmentEncoding::DICTIONARY;
+			TeeCopyValues(allocator, input, count, dictionary_rows, dictionary_size, segment);
+			segment.bit_width = bit_width;
+			segment.encoded = allocator.Allocate(packed_size);
+			BitpackingPrimitives::PackBuffer<uint32_t, false>(segment.encoded.get(), indices.get(), padded_count,
+			                                                  bit_width);
+			return;
+		}
+	}
+	if (rle_size < plain_size) {
+		segment.encoding = TeeSegmentEncoding::RLE;
+		TeeCopyValues(allocator, input, count, run_starts, run_count, segment);
+		segment.encoded = allocator.Allocate(run_count * sizeof(uint16_t));
+		memcpy(segment.encoded.get(), run_end_data, run_count * sizeof(uint16_t));
+		return;
+	}
+	TeeEncodePlain(allocator, input, count, segment);
+}
+
+static void TeeEncodeVector(Allocator &allocator, Vector &input, idx_t count, TeeCompressedSegment &segment) {
+	// constant vectors stay constant
+	if (input.GetVectorType() == VectorType::CONSTANT_VECTOR) {
+		TeeEncodeConstant(allocator, input, count, segment);
+		return;
+	}
+	switch (input.GetType().InternalType()) {
+	case PhysicalType::BOOL:
+		return TeeEncodeSegment<bool>(allocator, input, count, segment);
+	case PhysicalType::INT8:
+		return TeeEncodeSegment<int8_t>(allocator, input, count, segment);
+	case PhysicalType::INT16:
+		return TeeEncodeSegment<int16_t>(allocator, input, count, segment);
+	case PhysicalType::INT32:
+		return TeeEncodeSegment<int32_t>(allocator, input, count, segment);
+	case PhysicalType::INT64:
+		return TeeEncodeSegment<int64_t>(allocator, input, count, segment);
+	case PhysicalType::INT128:
+		return TeeEncodeSegment<hugeint_t>(allocator, input, count, segment);
+	case PhysicalType::UINT8:
+		return TeeEncodeSegment<uint8_t>(allocator, input, count, segment);
+	case PhysicalType::UINT16:
+		return TeeEncodeSegment<uint16_t>(allocator, input, count, segment);
+	case PhysicalType::UINT32:
+		return TeeEncodeSegment<uint32_t>(allocator, input, count, segment);
+	case PhysicalType::UINT64:
+		return TeeEncodeSegment<uint64_t>(allocator, input, count, segment);
+	case PhysicalType::UINT128:
+		return TeeEncodeSegment<uhugeint_t>(allocator, input, count, segment);
+	case PhysicalType::FLOAT:
+		return TeeEncodeSegment<float>(allocator, input, count, segment);
+	case PhysicalType::DOUBLE:
+		return TeeEncodeSegment<double>(allocator, input, count, segment);
+	case PhysicalType::INTERVAL:
+		return TeeEncodeSegment<interval_t>(allocator, input, count, segment);
+	case PhysicalType::VARCHAR:
+		return TeeEncodeSegment<string_t>(allocator, input, count, segment);
+	default:
+		throw InternalException("Tee: cannot compress a column of type %s", input.GetType().ToString());
+	}
+}
+
+void TeeCompressedSegment::Decode(Vector &result, idx_t count) const {
+	switch (encoding) {
+	case TeeSegmentEncoding::PLAIN:
+		result.Reference(*values);
+		return;
+	case TeeSegmentEncoding::CONSTANT:
+		ConstantVector::Reference(result, *values, 0, count);
+		return;
+	case TeeSegmentEncoding::RLE: {
+		auto run_ends = reinterpret_cast<const uint16_t *>(encoded.get());
+		SelectionVector sel(count);
+		idx_t row = 0;
+		for (idx_t run = 0; run < value_count; run++) {
+			for (; row < run_ends[run]; row++) {
+				sel.set_index(row, run);
+			}
+		}
+		result.Slice(*values, sel, count);
+		return;
+	}
+	case TeeSegmentEncoding::DICTIONARY: {
+		auto padded_count = AlignValue<idx_t, BitpackingPrimitives::BITPACKING_ALGORITHM_GROUP_SIZE>(count);
+		auto indices = make_unsafe_uniq_array<uint32_t>(padded_count);
+		auto packed = const_cast<data_ptr_t>(encoded.get());
+		BitpackingPrimitives::UnPackBuffer<uint32_t>(data_ptr_cast(indices.get()), packed, padded_count, bit_width);
+		SelectionVector sel(count);
+		for (idx_t row = 0; row < count; row++) {
+			sel.set_index(row, indices[row]);
+		}
+		result.Slice(*values, sel, count);
+		return;
+	}
+	default:
+		throw InternalException("Tee: unknown segment encoding");
+	}
+}
+
+TeeCompressedBuffer::TeeCompressedBuffer(ClientContext &context, vector<LogicalType> types_p)
+    : allocator(BufferAllocator::Get(context)), types(std::move(types_p)) {
+}
+
+bool TeeCompressedBuffer::SupportsTypes(const vector<LogicalType> &types) {
+	for (auto &type : types) {
+		if (type.IsNested()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void TeeCompressedBuffer::Append(DataChunk &chunk) {
+	if (chunk.size() == 0) {
+		return;
+	}
+	TeeCompressedChunk compressed_chunk;
+	compressed_chunk.count = chunk.size();
+	compressed_chunk.columns.resize(chunk.ColumnCount());
+	for (idx_t col = 0; col < chunk.ColumnCount(); col++) {
+		TeeEncodeVector(allocator, chunk.data[col], chunk.size(), compressed_chunk.columns[col]);
+	}
+	count += chunk.size();
+	chunks.push_back(std::move(compressed_chunk));
+}
+
+void TeeCompressedBuffer::Combine(TeeCompressedBuffer &other) {
+	for (auto &chunk : other.chunks) {
+		chunks.push_back(std::move(chunk));
+	}
+	count += other.count;
+	other.Reset();
+}
+
+void TeeCompressedBuffer::Reset() {
+	chunks.clear();
+	count = 0;
+}
+
+void TeeCompressedBuffer::FetchChunk(idx_t chunk_idx, DataChunk &result) const {
+	auto &compressed_chunk = chunks[chunk_idx];
+	for (idx_t col = 0; col < types.size(); col++) {
+		compressed_chunk.columns[col].Decode(result.data[col], compressed_chunk.count);
+	}
+	result.SetCardinality(compressed_chunk.count);
+}
+
+} // namespace duckdb
@@ -2,7 +2,11 @@
 #include "tee_logical.hpp"
 #include "tee_physical.hpp"
 #include "tee_parser.hpp"
+#include "tee_native.hpp"
+#include "duckdb/catalog/catalog.hpp"
 #include "duckdb/parser/parser_extension.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+#include "duckdb/planner/binder.hpp"
 
 namespace duckdb {
 
@@ -11,6 +15,17 @@ static unique_ptr<LogicalOperator> TeeBindOperator(ClientContext &context, Table
 	auto names = IdentifiersToStrings(input.input_table_names);
 	return_names = names;
 
+	// the table sink writes in the transaction of the query, unless the rows are group committed
+	auto table_name = input.named_parameters.find("table_name");
+	auto group_commit = input.named_parameters.find("group_commit");
+	bool group_committed = group_commit != input.named_parameters.end() && group_commit->second.GetValue<bool>();
+	if (table_name != input.named_parameters.end() && !group_committed && input.binder) {
+		auto qualified_name = QualifiedName::Parse(table_name->second.GetValue<string>());
+		Binder::BindSchemaOrCatalog(context, qualified_name.catalog, qualified_name.schema);
+		auto &catalog = Catalog::GetCatalog(context, qualified_name.catalog);
+		input.binder->GetStatementProperties().RegisterDBModify(catalog, context);
+	}
+
 	auto logical_tee = make_uniq<LogicalTee>(bind_index, input.input_table_types, names, input.named_parameters);
 
 	logical_tee->children.push_back(std::move(*input.input_plan));
@@ -27,12 +42,28 @@ static void LoadInternal(ExtensionLoader &loader) {
 	tee_function.named_parameters["table_name"] = LogicalType::VARCHAR;
 	tee_function.named_parameters["pager"] = LogicalType::BOOLEAN;
 	tee_function.named_parameters["maxrows"] = LogicalType::BIGINT;
+	tee_function.named_parameters["format"] = LogicalType::VARCHAR;
+	tee_function.named_parameters["fingerprint"] = LogicalType::BOOLEAN;
+	tee_function.named_parameters["compress"] = LogicalType::BOOLEAN;
+	tee_function.named_parameters["mode"] = LogicalType::VARCHAR;
+	tee_function.named_parameters["group_commit"] = LogicalType::BOOLEAN;
 	loader.RegisterFunction(tee_function);
 
+	loader.RegisterFunction(TeeReadFunction::GetFunction());
+
 	auto &db = loader.GetDatabaseInstance();
 	auto &config = DBConfig::GetConfig(db);
 
 	config.SetOptionByName("allow_parser_override_extension", Value("fallback"));
+	config.AddExtensionOption("tee_sink_idle_timeout",
+	                          "Seconds an append-mode tee sink stays open without being used", LogicalType::UBIGINT,
+	                          Value::UBIGINT(60));
+	config.AddExtensionOption("tee_group_commit_max_rows",
+	                          "Pending rows after which a group_commit tee commits its group right away",
+	                          LogicalType::UBIGINT, Value::UBIGINT(10000));
+	config.AddExtensionOption("tee_group_commit_max_wait_ms",
+	                          "Milliseconds a group_commit tee waits for other queries to join its group",
+	                          LogicalType::UBIGINT, Value::UBIGINT(10));
 
 	ParserExtension parser_extension;
 	parser_extension.parser_override = TeeParserExtension::ParserOverrideFunction;
@@ -0,0 +1,88 @@
+#include "include/tee_fingerprint.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/hash.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+
+namespace duckdb {
+
+TeeFingerprint::TeeFingerprint(idx_t column_count)
+    : column_hashes(column_count, 0), hashes(LogicalType::HASH),
+      row_hashes(make_unsafe_uniq_array<hash_t>(STANDARD_VECTOR_SIZE)) {
+}
+
+void TeeFingerprint::Update(DataChunk &chunk) {
+	auto count = chunk.size();
+	if (count == 0) {
+		return;
+	}
+	for (idx_t col = 0; col < chunk.ColumnCount(); col++) {
+		VectorOperations::Hash(chunk.data[col], hashes, count);
+		// constant input gives a constant hash vector
+		UnifiedVectorFormat format;
+		hashes.ToUnifiedFormat(count, format);
+		auto data = UnifiedVectorFormat::GetData<hash_t>(format);
+
+		hash_t column_hash = 0;
+		for (idx_t row = 0; row < count; row++) {
+			auto hash = data[format.sel->get_index(row)];
+			column_hash += hash;
+			row_hashes[row] = col == 0 ? hash : CombineHashScalar(row_hashes[row], hash);
+		}
+		column_hashes[col] += column_hash;
+	}
+	for (idx_t row = 0; row < count; row++) {
+		row_hash += row_hashes[row];
+	}
+	row_count += count;
+}
+
+void TeeFingerprint::Combine(const TeeFingerprint &other) {
+	D_ASSERT(column_hashes.size() == other.column_hashes.size());
+	row_count += other.row_count;
+	row_hash += other.row_hash;
+	for (idx_t col = 0; col < column_hashes.size(); col++) {
+		column_hashes[col] += other.column_hashes[col];
+	}
+}
+
+void TeeFingerprint::Reset() {
+	row_count = 0;
+	row_hash = 0;
+	std::fill(column_hashes.begin(), column_hashes.end(), 0);
+}
+
+string TeeFingerprint::ToString(const vector<string> &names) const {
+	string result = StringUtil::Format("rows = %llu, hash = %016x\n", row_count, row_hash);
+	for (idx_t col = 0; col < column_hashes.size(); col++) {
+		result += StringUtil::Format("  %s: %016x\n", names[col], column_hashes[col]);
+	}
+	return result;
+}
+
+vector<string> TeeFingerprint::TableNames() {
+	return {"column_name", "row_count", "fingerprint"};
+}
+
+vector<LogicalType> TeeFingerprint::TableTypes() {
+	return {LogicalType::VARCHAR, LogicalType::UBIGINT, LogicalType::UBIGINT};
+}
+
+void TeeFingerprint::ToChunk(const vector<string> &names, idx_t offset, DataChunk &result) const {
+	auto count = MinValue<idx_t>(TableRowCount() - offset, STANDARD_VECTOR_SIZE);
+	for (idx_t i = 0; i < count; i++) {
+		auto row = offset + i;
+		if (row == 0) {
+			// the whole-row fingerprint has no column name
+			result.SetValue(0, i, Value());
+			result.SetValue(1, i, Value::UBIGINT(row_count));
+			result.SetValue(2, i, Value::UBIGINT(row_hash));
+			continue;
+		}
+		result.SetValue(0, i, Value(names[row - 1]));
+		result.SetValue(1, i, Value::UBIGINT(row_count));
+		result.SetValue(2, i, Value::UBIGINT(column_hashes[row - 1]));
+	}
+	result.SetCardinality(count);
+}
+
+} // namespace duckdb
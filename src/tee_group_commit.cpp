@@ -0,0 +1,113 @@
+#include "include/tee_extension.hpp"
+#include "duckdb/catalog/catalog.hpp"
+#include "duckdb/main/connection.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/transaction/meta_transaction.hpp"
+
+namespace duckdb {
+
+TeeGroupCommitWriter::TeeGroupCommitWriter(DatabaseInstance &db, const QualifiedName &table_name)
+    : db(db), table_name(table_name), open_group(make_shared_ptr<TeeCommitGroup>()) {
+}
+
+shared_ptr<TeeGroupCommitWriter> TeeGroupCommitWriter::Get(ClientContext &context, const QualifiedName &table_name) {
+	auto key = "tee_group_commit:" + KeywordHelper::WriteOptionallyQuoted(table_name.catalog) + "." +
+	           KeywordHelper::WriteOptionallyQuoted(table_name.schema) + "." +
+	           KeywordHelper::WriteOptionallyQuoted(table_name.name);
+	auto &cache = ObjectCache::GetObjectCache(context);
+	return cache.GetOrCreate<TeeGroupCommitWriter>(key, *context.db, table_name);
+}
+
+void TeeGroupCommitWriter::Commit(const vector<string> &names, unique_ptr<ColumnDataCollection> rows,
+                                  idx_t max_rows, std::chrono::milliseconds max_wait) {
+	auto deadline = std::chrono::steady_clock::now() + max_wait;
+
+	unique_lock<mutex> guard(lock);
+	// held until this query has seen the outcome, the writer forgets the group once it is committed
+	auto group = open_group;
+	auto query_idx = group->rows.size();
+	group->row_count += rows->Count();
+	group->names.push_back(names);
+	group->rows.push_back(std::move(rows));
+
+	while (!group->committed) {
+		bool group_open = open_group == group;
+		if (group_open && !committing &&
+		    (group->row_count >= max_rows || std::chrono::steady_clock::now() >= deadline)) {
+			CommitGroup(guard);
+			continue;
+		}
+		if (group_open && !committing) {
+			group_committed.wait_until(guard, deadline);
+		} else {
+			// our rows are being committed, or wait behind the group that is
+			group_committed.wait(guard);
+		}
+	}
+
+	auto &error = group->errors[query_idx];
+	if (error.HasError()) {
+		error.Throw("Tee: group commit into " + table_name.name + " failed: ");
+	}
+}
+
+void TeeGroupCommitWriter::CommitGroup(unique_lock<mutex> &guard) {
+	auto group = std::move(open_group);
+	open_group = make_shared_ptr<TeeCommitGroup>();
+	committing = true;
+
+	// new rows already join the next group while this one is appended
+	guard.unlock();
+	group->errors.resize(group->rows.size());
+	try {
+		Connection con(db);
+		try {
+			con.context->RunFunctionInTransaction([&]() {
+				for (idx_t i = 0; i < group->rows.size(); i++) {
+					AppendQuery(*con.context, *group, i);
+				}
+			});
+		} catch (std::exception &ex) {
+			if (group->rows.size() == 1) {
+				throw;
+			}
+			// the rows of one query roll back the whole group, so every query is retried in its
+			// own transaction and only the queries whose rows fail see an error
+			for (idx_t i = 0; i < group->rows.size(); i++) {
+				try {
+					con.context->RunFunctionInTransaction([&]() { AppendQuery(*con.context, *group, i); });
+				} catch (std::exception &query_ex) {
+					group->errors[i] = ErrorData(query_ex);
+				}
+			}
+		}
+	} catch (std::exception &ex) {
+		ErrorData error(ex);
+		for (auto &query_error : group->errors) {
+			query_error = error;
+		}
+	}
+	group->rows.clear();
+	guard.lock();
+
+	group->committed = true;
+	committing = false;
+	group_committed.notify_all();
+}
+
+void TeeGroupCommitWriter::AppendQuery(ClientContext &context, TeeCommitGroup &group, idx_t query_idx) {
+	// like ClientContext::Append, so the commit writes the changes and a read-only database refuses them
+	auto &catalog = Catalog::GetCatalog(context, table_name.catalog);
+	MetaTransaction::Get(context).ModifyDatabase(catalog.GetAttached());
+
+	// a table sink per query, so the table is created again after a DROP and every
+	// query's columns are checked and cast against the table as it is now
+	auto &collection = *group.rows[query_idx];
+	TeeTableSink sink(context, table_name, group.names[query_idx], collection.Types());
+	for (auto &chunk : collection.Chunks()) {
+		sink.AppendChunk(chunk);
+	}
+	sink.Flush();
+}
+
+} // namespace duckdb
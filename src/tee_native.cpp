@@ -0,0 +1,595 @@
+#include "include/tee_native.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/printer.hpp"
+#include "duckdb/common/types/vector_buffer.hpp"
+
+#if !defined(_WIN32) && !defined(WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace duckdb {
+
+static const data_t TEE_NATIVE_PADDING[TeeNativeFormat::ALIGNMENT] = {};
+
+bool TeeNativeFormat::SupportsType(const LogicalType &type) {
+	switch (type.id()) {
+	case LogicalTypeId::BOOLEAN:
+	case LogicalTypeId::TINYINT:
+	case LogicalTypeId::SMALLINT:
+	case LogicalTypeId::INTEGER:
+	case LogicalTypeId::BIGINT:
+	case LogicalTypeId::HUGEINT:
+	case LogicalTypeId::UTINYINT:
+	case LogicalTypeId::USMALLINT:
+	case LogicalTypeId::UINTEGER:
+	case LogicalTypeId::UBIGINT:
+	case LogicalTypeId::UHUGEINT:
+	case LogicalTypeId::FLOAT:
+	case LogicalTypeId::DOUBLE:
+	case LogicalTypeId::DECIMAL:
+	case LogicalTypeId::DATE:
+	case LogicalTypeId::TIME:
+	case LogicalTypeId::TIME_TZ:
+	case LogicalTypeId::TIMESTAMP:
+	case LogicalTypeId::TIMESTAMP_SEC:
+	case LogicalTypeId::TIMESTAMP_MS:
+	case LogicalTypeId::TIMESTAMP_NS:
+	case LogicalTypeId::TIMESTAMP_TZ:
+	case LogicalTypeId::INTERVAL:
+	case LogicalTypeId::UUID:
+	case LogicalTypeId::VARCHAR:
+	case LogicalTypeId::BLOB:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Pads the stream up to the next section boundary
+static void TeeNativePad(MemoryStream &stream) {
+	auto position = stream.GetPosition();
+	auto padding = TeeNativeFormat::Align(position) - position;
+	if (padding > 0) {
+		stream.WriteData(TEE_NATIVE_PADDING, padding);
+	}
+}
+
+TeeNativeWriter::TeeNativeWriter(ClientContext &context, const string &path, const vector<string> &names_p,
+                                 const vector<LogicalType> &types_p, bool append)
+    : path(path), names(names_p), types(types_p), file_offset(0), previous_footer(0), previous_footer_end(0) {
+	for (auto &type : types) {
+		if (!TeeNativeFormat::SupportsType(type)) {
+			throw NotImplementedException("Tee: native format does not support type %s", type.ToString());
+		}
+	}
+	Printer::Print(OutputStream::STREAM_STDOUT, "Write to: " + path);
+	auto &fs = FileSystem::GetFileSystem(context);
+	if (append && fs.FileExists(path)) {
+		auto existing = TeeNativeFile::Open(context, path);
+		if (existing->names != names || existing->types != types) {
+			throw InvalidInputException("Tee: cannot append to '%s', it was written with a different schema", path);
+		}
+		// new chunks follow the last trailer and the next footer links back to the last one
+		handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_WRITE);
+		file_offset = NumericCast<idx_t>(handle->GetFileSize());
+		previous_footer = existing->footer_offset;
+		previous_footer_end = file_offset;
+		if (file_offset % TeeNativeFormat::ALIGNMENT != 0) {
+			throw IOException("Tee: cannot append to '%s', it does not end in a complete footer", path);
+		}
+		return;
+	}
+	handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_WRITE | FileFlags::FILE_FLAGS_FILE_CREATE_NEW);
+
+	MemoryStream header(TeeNativeFormat::HEADER_SIZE);
+	header.WriteData(const_data_ptr_cast(TeeNativeFormat::MAGIC), TeeNativeFormat::MAGIC_SIZE);
+	header.Write<uint32_t>(TeeNativeFormat::VERSION);
+	TeeNativePad(header);
+	handle->Write(header.GetData(), header.GetPosition(), 0);
+	file_offset = header.GetPosition();
+}
+
+void TeeNativeWriter::SerializeChunk(DataChunk &chunk, MemoryStream &stream) const {
+	auto count = chunk.size();
+	D_ASSERT(count <= STANDARD_VECTOR_SIZE);
+	stream.Rewind();
+
+	for (idx_t col = 0; col < chunk.ColumnCount(); col++) {
+		// constant and dictionary vectors are expanded, flat vectors are written as they are
+		Vector flat(chunk.data[col].GetType());
+		flat.Reference(chunk.data[col]);
+		flat.Flatten(count);
+
+		auto &validity = FlatVector::Validity(flat);
+		auto validity_size = ValidityMask::ValidityMaskSize(count);
+		if (validity.AllValid()) {
+			validity_t all_valid[ValidityMask::STANDARD_ENTRY_COUNT];
+			memset(all_valid, 0xFF, validity_size);
+			stream.WriteData(data_ptr_cast(all_valid), validity_size);
+		} else {
+			stream.WriteData(data_ptr_cast(validity.GetData()), validity_size);
+		}
+		TeeNativePad(stream);
+
+		if (!TeeNativeFormat::IsStringType(types[col])) {
+			auto width = GetTypeIdSize(types[col].InternalType());
+			stream.WriteData(FlatVector::GetData(flat), count * width);
+			TeeNativePad(stream);
+			continue;
+		}
+
+		// offsets first so the reader finds the heap without scanning it
+		auto strings = FlatVector::GetData<string_t>(flat);
+		uint64_t offset = 0;
+		stream.Write<uint64_t>(offset);
+		for (idx_t row = 0; row < count; row++) {
+			if (validity.RowIsValid(row)) {
+				offset += strings[row].GetSize();
+			}
+			stream.Write<uint64_t>(offset);
+		}
+		TeeNativePad(stream);
+		for (idx_t row = 0; row < count; row++) {
+			if (validity.RowIsValid(row)) {
+				stream.WriteData(const_data_ptr_cast(strings[row].GetData()), strings[row].GetSize());
+			}
+		}
+		TeeNativePad(stream);
+	}
+}
+
+TeeNativeWriter::~TeeNativeWriter() {
+	try {
+		Close();
+	} catch (std::exception &ex) {
+		// every query flushes its footer, a failed close only loses chunks of a failed query
+	}
+}
+
+void TeeNativeWriter::WriteChunk(DataChunk &chunk, MemoryStream &local_stream) {
+	if (chunk.size() == 0) {
+		return;
+	}
+	SerializeChunk(chunk, local_stream);
+
+	lock_guard<mutex> guard(write_lock);
+	if (invalidated) {
+		throw IOException("Tee: '%s' was overwritten while it was appended to", path);
+	}
+	if (!handle) {
+		throw InternalException("Tee: native writer of '%s' is already closed", path);
+	}
+	handle->Write(local_stream.GetData(), local_stream.GetPosition(), file_offset);
+	chunks.push_back({file_offset, chunk.size()});
+	file_offset += local_stream.GetPosition();
+}
+
+void TeeNativeWriter::Flush() {
+	lock_guard<mutex> guard(write_lock);
+	// without new chunks the last footer still describes the file
+	if (handle && (!chunks.empty() || previous_footer == 0)) {
+		WriteFooter();
+	}
+}
+
+void TeeNativeWriter::Close() {
+	lock_guard<mutex> guard(write_lock);
+	if (!handle) {
+		return;
+	}
+	if (!chunks.empty() || previous_footer == 0) {
+		WriteFooter();
+	}
+	handle->Close();
+	handle.reset();
+}
+
+void TeeNativeWriter::Invalidate() {
+	lock_guard<mutex> guard(write_lock);
+	// no footer, the chunks it would list are gone with the old file
+	invalidated = true;
+	chunks.clear();
+	if (handle) {
+		handle->Close();
+		handle.reset();
+	}
+}
+
+bool TeeNativeWriter::IsInvalidated() {
+	lock_guard<mutex> guard(write_lock);
+	return invalidated;
+}
+
+shared_ptr<TeeNativeAppendWriters> TeeNativeAppendWriters::Get(ClientContext &context) {
+	auto &cache = ObjectCache::GetObjectCache(context);
+	return cache.GetOrCreate<TeeNativeAppendWriters>(ObjectType());
+}
+
+shared_ptr<TeeNativeWriter> TeeNativeAppendWriters::GetWriter(ClientContext &context, const string &path,
+                                                              const vector<string> &names,
+                                                              const vector<LogicalType> &types) {
+	auto key = FileSystem::GetFileSystem(context).ExpandPath(path);
+	lock_guard<mutex> guard(lock);
+	auto entry = writers.find(key);
+	if (entry != writers.end()) {
+		auto writer = entry->second.lock();
+		if (writer && !writer->IsInvalidated()) {
+			if (!writer->Matches(names, types)) {
+				throw InvalidInputException("Tee: cannot append to '%s', it was written with a different schema",
+				                            path);
+			}
+			return writer;
+		}
+	}
+	auto writer = make_shared_ptr<TeeNativeWriter>(context, path, names, types, true);
+	writers[key] = writer;
+	return writer;
+}
+
+void TeeNativeAppendWriters::Invalidate(ClientContext &context, const string &path) {
+	auto key = FileSystem::GetFileSystem(context).ExpandPath(path);
+	lock_guard<mutex> guard(lock);
+	auto entry = writers.find(key);
+	if (entry == writers.end()) {
+		return;
+	}
+	auto writer = entry->second.lock();
+	if (writer) {
+		writer->Invalidate();
+	}
+	writers.erase(entry);
+}
+
+// Writes the footer with trailer right after the last chunk, padded so the next chunk starts aligned
+void TeeNativeWriter::WriteFooter() {
+	MemoryStream footer;
+	footer.Write<uint64_t>(types.size());
+	for (idx_t col = 0; col < types.size(); col++) {
+		footer.Write<uint32_t>(UnsafeNumericCast<uint32_t>(names[col].size()));
+		footer.WriteData(const_data_ptr_cast(names[col].c_str()), names[col].size());
+		footer.Write<uint8_t>(static_cast<uint8_t>(types[col].id()));
+		uint8_t width = 0;
+		uint8_t scale = 0;
+		if (types[col].id() == LogicalTypeId::DECIMAL) {
+			width = DecimalType::GetWidth(types[col]);
+			scale = DecimalType::GetScale(types[col]);
+		}
+		footer.Write<uint8_t>(width);
+		footer.Write<uint8_t>(scale);
+	}
+	footer.Write<uint64_t>(chunks.size());
+	for (auto &entry : chunks) {
+		footer.Write<uint64_t>(entry.offset);
+		footer.Write<uint64_t>(entry.count);
+	}
+	footer.Write<uint64_t>(previous_footer);
+	footer.Write<uint64_t>(previous_footer_end);
+	auto footer_size = footer.GetPosition() + TeeNativeFormat::TRAILER_SIZE;
+	auto padding = TeeNativeFormat::Align(footer_size) - footer_size;
+	if (padding > 0) {
+		footer.WriteData(TEE_NATIVE_PADDING, padding);
+	}
+	footer.Write<uint64_t>(file_offset);
+	footer.WriteData(const_data_ptr_cast(TeeNativeFormat::MAGIC), TeeNativeFormat::MAGIC_SIZE);
+
+	handle->Write(footer.GetData(), footer.GetPosition(), file_offset);
+	previous_footer = file_offset;
+	file_offset += footer.GetPosition();
+	previous_footer_end = file_offset;
+	chunks.clear();
+}
+
+TeeNativeFile::~TeeNativeFile() {
+#if !defined(_WIN32) && !defined(WIN32)
+	if (mapped) {
+		munmap(data, size);
+	}
+#endif
+}
+
+void TeeNativeFile::MapFile(const string &path) {
+#if !defined(_WIN32) && !defined(WIN32)
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return;
+	}
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+		close(fd);
+		return;
+	}
+	// private and writable, so consumers that modify vectors in place only touch their own page copy
+	auto mapping = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		return;
+	}
+	data = static_cast<data_ptr_t>(mapping);
+	size = static_cast<idx_t>(file_stat.st_size);
+	mapped = true;
+#endif
+}
+
+shared_ptr<TeeNativeFile> TeeNativeFile::Open(ClientContext &context, const string &path) {
+	auto result = make_shared_ptr<TeeNativeFile>(Allocator::Get(context));
+	auto &fs = FileSystem::GetFileSystem(context);
+	// opened through the file system first, so enable_external_access and allowed_directories apply
+	result->handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ);
+	result->size = NumericCast<idx_t>(result->handle->GetFileSize());
+	if (result->handle->file_system.GetName() == "LocalFileSystem") {
+		result->MapFile(fs.ExpandPath(path));
+	}
+	if (result->mapped) {
+		result->handle.reset();
+	}
+	result->ReadFooter(path);
+	return result;
+}
+
+data_ptr_t TeeNativeFile::ReadRange(idx_t offset, idx_t length, AllocatedData &buffer) const {
+	D_ASSERT(offset + length <= size);
+	if (mapped) {
+		return data + offset;
+	}
+	buffer = allocator.Allocate(length);
+	lock_guard<mutex> guard(read_lock);
+	handle->Read(buffer.get(), length, offset);
+	return buffer.get();
+}
+
+void TeeNativeFile::ReadFooter(const string &path) {
+	AllocatedData buffer;
+	if (size < TeeNativeFormat::HEADER_SIZE + TeeNativeFormat::TRAILER_SIZE) {
+		throw IOException("Tee: '%s' is not a native tee file", path);
+	}
+	auto header = ReadRange(0, TeeNativeFormat::MAGIC_SIZE + sizeof(uint32_t), buffer);
+	if (memcmp(header, TeeNativeFormat::MAGIC, TeeNativeFormat::MAGIC_SIZE) != 0) {
+		throw IOException("Tee: '%s' is not a native tee file", path);
+	}
+	auto version = Load<uint32_t>(header + TeeNativeFormat::MAGIC_SIZE);
+	if (version != TeeNativeFormat::VERSION) {
+		throw IOException("Tee: '%s' has native format version %d, expected %d", path, version,
+		                  TeeNativeFormat::VERSION);
+	}
+	auto trailer = ReadRange(size - TeeNativeFormat::TRAILER_SIZE, TeeNativeFormat::TRAILER_SIZE, buffer);
+	if (memcmp(trailer + sizeof(uint64_t), TeeNativeFormat::MAGIC, TeeNativeFormat::MAGIC_SIZE) != 0) {
+		throw IOException("Tee: '%s' is not a native tee file", path);
+	}
+	footer_offset = Load<uint64_t>(trailer);
+
+	// the footers are read from the last one back, each only lists the chunks before it
+	vector<vector<TeeNativeChunkEntry>> footer_chunks;
+	vector<vector<idx_t>> footer_chunk_ends;
+	auto offset = footer_offset;
+	// where the trailer of the footer at offset ends
+	auto end = size;
+	while (true) {
+		if (offset < TeeNativeFormat::HEADER_SIZE || offset > end - TeeNativeFormat::TRAILER_SIZE) {
+			throw IOException("Tee: '%s' has a corrupt footer", path);
+		}
+		auto footer_size = end - offset - TeeNativeFormat::TRAILER_SIZE;
+		auto footer_data = ReadRange(offset, end - offset, buffer);
+		auto footer_trailer = footer_data + footer_size;
+		if (Load<uint64_t>(footer_trailer) != offset ||
+		    memcmp(footer_trailer + sizeof(uint64_t), TeeNativeFormat::MAGIC, TeeNativeFormat::MAGIC_SIZE) != 0) {
+			throw IOException("Tee: '%s' has a corrupt footer", path);
+		}
+
+		MemoryStream footer(footer_data, footer_size);
+		vector<string> footer_names;
+		vector<LogicalType> footer_types;
+		auto column_count = footer.Read<uint64_t>();
+		for (idx_t col = 0; col < column_count; col++) {
+			auto name_size = footer.Read<uint32_t>();
+			string name(name_size, '\0');
+			footer.ReadData(data_ptr_cast(&name[0]), name_size);
+			footer_names.push_back(std::move(name));
+
+			auto type_id = static_cast<LogicalTypeId>(footer.Read<uint8_t>());
+			auto width = footer.Read<uint8_t>();
+			auto scale = footer.Read<uint8_t>();
+			auto type = type_id == LogicalTypeId::DECIMAL ? LogicalType::DECIMAL(width, scale) : LogicalType(type_id);
+			if (!TeeNativeFormat::SupportsType(type)) {
+				throw IOException("Tee: '%s' contains an unsupported column type", path);
+			}
+			footer_types.push_back(std::move(type));
+		}
+		if (footer_chunks.empty()) {
+			names = std::move(footer_names);
+			types = std::move(footer_types);
+		} else if (footer_names != names || footer_types != types) {
+			throw IOException("Tee: '%s' has footers with different schemas", path);
+		}
+
+		vector<TeeNativeChunkEntry> entries;
+		auto chunk_count = footer.Read<uint64_t>();
+		for (idx_t i = 0; i < chunk_count; i++) {
+			TeeNativeChunkEntry entry;
+			entry.offset = footer.Read<uint64_t>();
+			entry.count = footer.Read<uint64_t>();
+			entries.push_back(entry);
+		}
+		auto previous = footer.Read<uint64_t>();
+		auto previous_end = footer.Read<uint64_t>();
+		// footers only point backwards, so the chain ends
+		if (previous != 0 && (previous >= previous_end || previous_end > offset)) {
+			throw IOException("Tee: '%s' has a corrupt footer", path);
+		}
+
+		// the chunks lie in order between the previous footer and this one, each ends where the next starts
+		vector<idx_t> ends;
+		auto chunk_start = previous == 0 ? TeeNativeFormat::HEADER_SIZE : previous_end;
+		for (idx_t i = 0; i < entries.size(); i++) {
+			auto &entry = entries[i];
+			if (entry.offset < chunk_start || entry.offset >= offset || entry.count > STANDARD_VECTOR_SIZE ||
+			    entry.offset % TeeNativeFormat::ALIGNMENT != 0) {
+				throw IOException("Tee: '%s' has a corrupt chunk index", path);
+			}
+			chunk_start = entry.offset + 1;
+			ends.push_back(i + 1 < entries.size() ? entries[i + 1].offset : offset);
+		}
+		footer_chunks.push_back(std::move(entries));
+		footer_chunk_ends.push_back(std::move(ends));
+
+		if (previous == 0) {
+			break;
+		}
+		end = previous_end;
+		offset = previous;
+	}
+
+	for (idx_t i = footer_chunks.size(); i > 0; i--) {
+		auto &entries = footer_chunks[i - 1];
+		chunks.insert(chunks.end(), entries.begin(), entries.end());
+		auto &ends = footer_chunk_ends[i - 1];
+		chunk_ends.insert(chunk_ends.end(), ends.begin(), ends.end());
+	}
+}
+
+// Owns a chunk read from a file that is not mapped, for as long as a vector points into it
+class TeeNativeChunkBuffer : public VectorBuffer {
+public:
+	explicit TeeNativeChunkBuffer(AllocatedData data_p)
+	    : VectorBuffer(VectorBufferType::OPAQUE_BUFFER), data(std::move(data_p)) {
+	}
+
+	AllocatedData data;
+};
+
+void TeeNativeFile::ScanChunk(idx_t chunk_idx, DataChunk &output, const buffer_ptr<VectorBuffer> &keep_alive) const {
+	auto &entry = chunks[chunk_idx];
+	auto count = entry.count;
+	auto chunk_size = chunk_ends[chunk_idx] - entry.offset;
+
+	AllocatedData chunk_data;
+	auto ptr = ReadRange(entry.offset, chunk_size, chunk_data);
+	auto end = ptr + chunk_size;
+	auto chunk_keep_alive = keep_alive;
+	if (!mapped) {
+		chunk_keep_alive = make_buffer<TeeNativeChunkBuffer>(std::move(chunk_data));
+	}
+
+	// tee_read accepts any file, so every section is checked against the end before it is read
+	auto next_section = [&](idx_t section_size) {
+		auto remaining = static_cast<idx_t>(end - ptr);
+		if (section_size > remaining || TeeNativeFormat::Align(section_size) > remaining) {
+			throw IOException("Tee: native chunk %d exceeds the file", chunk_idx);
+		}
+		auto section = ptr;
+		ptr += TeeNativeFormat::Align(section_size);
+		return section;
+	};
+
+	for (idx_t col = 0; col < types.size(); col++) {
+		auto &vector = output.data[col];
+		auto validity_data = next_section(ValidityMask::ValidityMaskSize(count));
+		ValidityMask validity(reinterpret_cast<validity_t *>(validity_data), count);
+
+		if (!TeeNativeFormat::IsStringType(types[col])) {
+			auto width = GetTypeIdSize(types[col].InternalType());
+			FlatVector::SetData(vector, next_section(count * width));
+			FlatVector::SetValidity(vector, validity);
+			vector.SetAuxiliary(chunk_keep_alive);
+			continue;
+		}
+
+		auto offsets = reinterpret_cast<const uint64_t *>(next_section((count + 1) * sizeof(uint64_t)));
+		for (idx_t row = 0; row < count; row++) {
+			if (offsets[row] > offsets[row + 1] ||
+			    offsets[row + 1] - offsets[row] > NumericLimits<uint32_t>::Maximum()) {
+				throw IOException("Tee: native chunk %d has corrupt string offsets", chunk_idx);
+			}
+		}
+		// with monotonic offsets, every string lies inside the heap once its end does
+		auto heap = next_section(offsets[count]);
+
+		// long strings keep pointing into the heap, only the string_t headers are built here
+		auto strings = FlatVector::GetData<string_t>(vector);
+		for (idx_t row = 0; row < count; row++) {
+			strings[row] = string_t(const_char_ptr_cast(heap + offsets[row]),
+			                        UnsafeNumericCast<uint32_t>(offsets[row + 1] - offsets[row]));
+		}
+		FlatVector::SetValidity(vector, validity);
+		StringVector::AddBuffer(vector, chunk_keep_alive);
+	}
+	output.SetCardinality(count);
+}
+
+// Owns a reference to the mapping for as long as a vector points into it
+class TeeNativeFileBuffer : public VectorBuffer {
+public:
+	explicit TeeNativeFileBuffer(shared_ptr<TeeNativeFile> file_p)
+	    : VectorBuffer(VectorBufferType::OPAQUE_BUFFER), file(std::move(file_p)) {
+	}
+
+	shared_ptr<TeeNativeFile> file;
+};
+
+struct TeeReadBindData : public TableFunctionData {
+	string path;
+	vector<LogicalType> types;
+	idx_t row_count = 0;
+};
+
+struct TeeReadGlobalState : public GlobalTableFunctionState {
+	shared_ptr<TeeNativeFile> file;
+	buffer_ptr<VectorBuffer> keep_alive;
+	atomic<idx_t> next_chunk {0};
+
+	idx_t MaxThreads() const override {
+		return MaxValue<idx_t>(file->chunks.size(), 1);
+	}
+};
+
+static unique_ptr<FunctionData> TeeReadBind(ClientContext &context, TableFunctionBindInput &input,
+                                            vector<LogicalType> &return_types, vector<string> &names) {
+	auto result = make_uniq<TeeReadBindData>();
+	result->path = input.inputs[0].GetValue<string>();
+
+	// only the footers are read here, the scan opens the file again
+	auto file = TeeNativeFile::Open(context, result->path);
+	for (auto &entry : file->chunks) {
+		result->row_count += entry.count;
+	}
+	result->types = file->types;
+	return_types = file->types;
+	names = file->names;
+	return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> TeeReadInitGlobal(ClientContext &context,
+                                                              TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<TeeReadBindData>();
+	auto result = make_uniq<TeeReadGlobalState>();
+	result->file = TeeNativeFile::Open(context, bind_data.path);
+	if (result->file->types != bind_data.types) {
+		throw IOException("Tee: '%s' changed since the query was bound", bind_data.path);
+	}
+	result->keep_alive = make_buffer<TeeNativeFileBuffer>(result->file);
+	return std::move(result);
+}
+
+static void TeeReadScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &g_state = data.global_state->Cast<TeeReadGlobalState>();
+	auto chunk_idx = g_state.next_chunk++;
+	if (chunk_idx >= g_state.file->chunks.size()) {
+		return;
+	}
+	g_state.file->ScanChunk(chunk_idx, output, g_state.keep_alive);
+}
+
+static unique_ptr<NodeStatistics> TeeReadCardinality(ClientContext &context, const FunctionData *bind_data_p) {
+	auto &bind_data = bind_data_p->Cast<TeeReadBindData>();
+	return make_uniq<NodeStatistics>(bind_data.row_count, bind_data.row_count);
+}
+
+TableFunction TeeReadFunction::GetFunction() {
+	TableFunction function("tee_read", {LogicalType::VARCHAR}, TeeReadScan, TeeReadBind, TeeReadInitGlobal);
+	function.cardinality = TeeReadCardinality;
+	return function;
+}
+
+} // namespace duckdb
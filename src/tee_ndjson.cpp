@@ -0,0 +1,337 @@
+#include "include/tee_ndjson.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/printer.hpp"
+#include "duckdb/common/types/vector.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+
+namespace duckdb {
+
+static inline void TeeWriteChar(MemoryStream &stream, char c) {
+	stream.Write<char>(c);
+}
+
+static inline void TeeWriteRaw(MemoryStream &stream, const char *data, idx_t size) {
+	stream.WriteData(const_data_ptr_cast(data), size);
+}
+
+static inline bool TeeJSONNeedsEscape(unsigned char c) {
+	return c < 0x20 || c == '"' || c == '\\';
+}
+
+static void TeeWriteJSONString(MemoryStream &stream, const char *data, idx_t size) {
+	TeeWriteChar(stream, '"');
+	idx_t start = 0;
+	for (idx_t i = 0; i < size; i++) {
+		auto c = static_cast<unsigned char>(data[i]);
+		if (!TeeJSONNeedsEscape(c)) {
+			continue;
+		}
+		// everything up to the escaped character goes out in one piece
+		TeeWriteRaw(stream, data + start, i - start);
+		start = i + 1;
+		switch (c) {
+		case '"':
+			TeeWriteRaw(stream, "\\\"", 2);
+			break;
+		case '\\':
+			TeeWriteRaw(stream, "\\\\", 2);
+			break;
+		case '\n':
+			TeeWriteRaw(stream, "\\n", 2);
+			break;
+		case '\r':
+			TeeWriteRaw(stream, "\\r", 2);
+			break;
+		case '\t':
+			TeeWriteRaw(stream, "\\t", 2);
+			break;
+		case '\b':
+			TeeWriteRaw(stream, "\\b", 2);
+			break;
+		case '\f':
+			TeeWriteRaw(stream, "\\f", 2);
+			break;
+		default: {
+			static const char *HEX = "0123456789abcdef";
+			char escaped[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF]};
+			TeeWriteRaw(stream, escaped, 6);
+			break;
+		}
+		}
+	}
+	TeeWriteRaw(stream, data + start, size - start);
+	TeeWriteChar(stream, '"');
+}
+
+static string TeeEscapeJSONKey(const string &name, bool first) {
+	MemoryStream stream;
+	if (!first) {
+		TeeWriteChar(stream, ',');
+	}
+	TeeWriteJSONString(stream, name.c_str(), name.size());
+	TeeWriteChar(stream, ':');
+	return string(const_char_ptr_cast(stream.GetData()), stream.GetPosition());
+}
+
+static void TeeWriteUnsigned(MemoryStream &stream, uint64_t value) {
+	char buffer[20];
+	auto end = buffer + sizeof(buffer);
+	auto ptr = end;
+	do {
+		*--ptr = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while (value > 0);
+	TeeWriteRaw(stream, ptr, NumericCast<idx_t>(end - ptr));
+}
+
+static void TeeWriteSigned(MemoryStream &stream, int64_t value) {
+	if (value < 0) {
+		TeeWriteChar(stream, '-');
+		TeeWriteUnsigned(stream, ~static_cast<uint64_t>(value) + 1);
+		return;
+	}
+	TeeWriteUnsigned(stream, static_cast<uint64_t>(value));
+}
+
+static inline void TeeWriteJSONValue(MemoryStream &stream, const TeeJSONField &field,
+                                     const RecursiveUnifiedVectorFormat &format, idx_t row) {
+	auto idx = format.unified.sel->get_index(row);
+	if (!format.unified.validity.RowIsValid(idx)) {
+		TeeWriteRaw(stream, "null", 4);
+		return;
+	}
+	field.write(stream, field, format, idx);
+}
+
+static void TeeWriteJSONBoolean(MemoryStream &stream, const TeeJSONField &field,
+                                const RecursiveUnifiedVectorFormat &format, idx_t idx) {
+	if (UnifiedVectorFormat::GetData<bool>(format.unified)[idx]) {
+		TeeWriteRaw(stream, "true", 4);
+	} else {
+		TeeWriteRaw(stream, "false", 5);
+	}
+}
+
+template <class T>
+static void TeeWriteJSONSigned(MemoryStream &stream, const TeeJSONField &field,
+                               const RecursiveUnifiedVectorFormat &format, idx_t idx) {
+	TeeWriteSigned(stream, UnifiedVectorFormat::GetData<T>(format.unified)[idx]);
+}
+
+template <class T>
+static void TeeWriteJSONUnsigned(MemoryStream &stream, const TeeJSONField &field,
+                                 const RecursiveUnifiedVectorFormat &format, idx_t idx) {
+	TeeWriteUnsigned(stream, UnifiedVectorFormat::GetData<T>(format.unified)[idx]);
+}
+
+static void TeeWriteJSONText(MemoryStream &stream, const TeeJSONField &field,
+                             const RecursiveUnifiedVectorFormat &format, idx_t idx) {
+	auto &value = UnifiedVectorFormat::GetData<string_t>(format.unified)[idx];
+	TeeWriteJSONString(stream, value.GetData(), value.GetSize());
+}
+
+// the JSON type already holds valid JSON
+static void TeeWriteJSONRaw(MemoryStream &stream, const TeeJSONField &field,
+                            const RecursiveUnifiedVectorFormat &format, idx_t idx) {
+	auto &value = UnifiedVectorFormat::GetData<string_t>(format.unified)[idx];
+	TeeWriteRaw(stream, value.GetData(), value.GetSize());
+}
+
+static void TeeWriteJSONNumberText(MemoryStream &stream, const TeeJSONField &field,
+                                   const RecursiveUnifiedVectorFormat &format, idx_t idx) {
+	auto &value = UnifiedVectorFormat::GetData<string_t>(format.unified)[idx];
+	// JSON has no nan or infinity
+	auto first = value.GetSize() > 0 ? value.GetData()[0] : '\0';
+	if (first == 'n' || first == 'i' || (first == '-' && value.GetSize() > 1 && value.GetData()[1] == 'i')) {
+		TeeWriteRaw(stream, "null", 4);
+		return;
+	}
+	TeeWriteRaw(stream, value.GetData(), value.GetSize());
+}
+
+static void TeeWriteJSONObject(MemoryStream &stream, const TeeJSONField &field,
+                               const vector<RecursiveUnifiedVectorFormat> &children, idx_t idx) {
+	TeeWriteChar(stream, '{');
+	for (idx_t i = 0; i < field.children.size(); i++) {
+		TeeWriteRaw(stream, field.keys[i].c_str(), field.keys[i].size());
+		TeeWriteJSONValue(stream, field.children[i], children[i], idx);
+	}
+	TeeWriteChar(stream, '}');
+}
+
+static void TeeWriteJSONStruct(MemoryStream &stream, const TeeJSONField &field,
+                               const RecursiveUnifiedVectorFormat &format, idx_t idx) {
+	TeeWriteJSONObject(stream, field, format.children, idx);
+}
+
+static void TeeWriteJSONList(MemoryStream &stream, const TeeJSONField &field,
+                             const RecursiveUnifiedVectorFormat &format, idx_t idx) {
+	auto &entry = UnifiedVectorFormat::GetData<list_entry_t>(format.unified)[idx];
+	TeeWriteChar(stream, '[');
+	for (idx_t i = 0; i < entry.length; i++) {
+		if (i > 0) {
+			TeeWriteChar(stream, ',');
+		}
+		TeeWriteJSONValue(stream, field.children[0], format.children[0], entry.offset + i);
+	}
+	TeeWriteChar(stream, ']');
+}
+
+static void TeeWriteJSONMap(MemoryStream &stream, const TeeJSONField &field,
+                            const RecursiveUnifiedVectorFormat &format, idx_t idx) {
+	auto &entry = UnifiedVectorFormat::GetData<list_entry_t>(format.unified)[idx];
+	auto &entries = format.children[0];
+	auto keys = UnifiedVectorFormat::GetData<string_t>(entries.children[0].unified);
+	TeeWriteChar(stream, '{');
+	for (idx_t i = 0; i < entry.length; i++) {
+		if (i > 0) {
+			TeeWriteChar(stream, ',');
+		}
+		auto entry_idx = entries.unified.sel->get_index(entry.offset + i);
+		auto &key = keys[entries.children[0].unified.sel->get_index(entry_idx)];
+		TeeWriteJSONString(stream, key.GetData(), key.GetSize());
+		TeeWriteChar(stream, ':');
+		TeeWriteJSONValue(stream, field.children[1], entries.children[1], entry_idx);
+	}
+	TeeWriteChar(stream, '}');
+}
+
+static TeeJSONField TeeCreateJSONField(const LogicalType &type) {
+	TeeJSONField field;
+	field.cast_type = type;
+	switch (type.id()) {
+	case LogicalTypeId::BOOLEAN:
+		field.write = TeeWriteJSONBoolean;
+		break;
+	case LogicalTypeId::TINYINT:
+		field.write = TeeWriteJSONSigned<int8_t>;
+		break;
+	case LogicalTypeId::SMALLINT:
+		field.write = TeeWriteJSONSigned<int16_t>;
+		break;
+	case LogicalTypeId::INTEGER:
+		field.write = TeeWriteJSONSigned<int32_t>;
+		break;
+	case LogicalTypeId::BIGINT:
+		field.write = TeeWriteJSONSigned<int64_t>;
+		break;
+	case LogicalTypeId::UTINYINT:
+		field.write = TeeWriteJSONUnsigned<uint8_t>;
+		break;
+	case LogicalTypeId::USMALLINT:
+		field.write = TeeWriteJSONUnsigned<uint16_t>;
+		break;
+	case LogicalTypeId::UINTEGER:
+		field.write = TeeWriteJSONUnsigned<uint32_t>;
+		break;
+	case LogicalTypeId::UBIGINT:
+		field.write = TeeWriteJSONUnsigned<uint64_t>;
+		break;
+	case LogicalTypeId::VARCHAR:
+		// the JSON type is a VARCHAR alias
+		field.write = type.IsJSONType() ? TeeWriteJSONRaw : TeeWriteJSONText;
+		break;
+	case LogicalTypeId::HUGEINT:
+	case LogicalTypeId::UHUGEINT:
+	case LogicalTypeId::DECIMAL:
+	case LogicalTypeId::FLOAT:
+	case LogicalTypeId::DOUBLE:
+		// DuckDB's own shortest round-trip formatting, written without quotes
+		field.cast_type = LogicalType::VARCHAR;
+		field.write = TeeWriteJSONNumberText;
+		break;
+	case LogicalTypeId::STRUCT: {
+		child_list_t<LogicalType> cast_children;
+		auto &child_types = StructType::GetChildTypes(type);
+		for (idx_t i = 0; i < child_types.size(); i++) {
+			field.keys.push_back(TeeEscapeJSONKey(child_types[i].first, i == 0));
+			field.children.push_back(TeeCreateJSONField(child_types[i].second));
+			cast_children.emplace_back(child_types[i].first, field.children.back().cast_type);
+		}
+		field.cast_type = LogicalType::STRUCT(std::move(cast_children));
+		field.write = TeeWriteJSONStruct;
+		break;
+	}
+	case LogicalTypeId::LIST:
+		field.children.push_back(TeeCreateJSONField(ListType::GetChildType(type)));
+		field.cast_type = LogicalType::LIST(field.children[0].cast_type);
+		field.write = TeeWriteJSONList;
+		break;
+	case LogicalTypeId::ARRAY:
+		// written like a list
+		field.children.push_back(TeeCreateJSONField(ArrayType::GetChildType(type)));
+		field.cast_type = LogicalType::LIST(field.children[0].cast_type);
+		field.write = TeeWriteJSONList;
+		break;
+	case LogicalTypeId::MAP: {
+		// keys become JSON object keys, so they are always strings
+		field.children.push_back(TeeCreateJSONField(LogicalType::VARCHAR));
+		field.children.push_back(TeeCreateJSONField(MapType::ValueType(type)));
+		field.cast_type = LogicalType::MAP(LogicalType::VARCHAR, field.children[1].cast_type);
+		field.write = TeeWriteJSONMap;
+		break;
+	}
+	default:
+		// dates, timestamps, uuids, blobs, enums, ... use their text form
+		field.cast_type = LogicalType::VARCHAR;
+		field.write = TeeWriteJSONText;
+		break;
+	}
+	return field;
+}
+
+TeeNDJSONWriter::TeeNDJSONWriter(ClientContext &context, const string &path, const vector<string> &names,
+                                 const vector<LogicalType> &types, bool append) {
+	for (idx_t col = 0; col < names.size(); col++) {
+		row.keys.push_back(TeeEscapeJSONKey(names[col], col == 0));
+		row.children.push_back(TeeCreateJSONField(types[col]));
+	}
+	Printer::Print(OutputStream::STREAM_STDOUT, "Write to: " + path);
+	auto &fs = FileSystem::GetFileSystem(context);
+	if (append) {
+		handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_WRITE | FileFlags::FILE_FLAGS_FILE_CREATE |
+		                               FileFlags::FILE_FLAGS_APPEND);
+	} else {
+		handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_WRITE | FileFlags::FILE_FLAGS_FILE_CREATE_NEW);
+	}
+}
+
+void TeeNDJSONWriter::WriteChunk(ClientContext &context, DataChunk &chunk, MemoryStream &local_stream) {
+	auto count = chunk.size();
+	if (count == 0) {
+		return;
+	}
+	// one vectorized cast per column that has leaves without a JSON representation
+	vector<Vector> cast_vectors;
+	cast_vectors.reserve(chunk.ColumnCount());
+	vector<RecursiveUnifiedVectorFormat> formats(chunk.ColumnCount());
+	for (idx_t col = 0; col < chunk.ColumnCount(); col++) {
+		auto &cast_type = row.children[col].cast_type;
+		if (chunk.data[col].GetType() == cast_type) {
+			Vector::RecursiveToUnifiedFormat(chunk.data[col], count, formats[col]);
+			continue;
+		}
+		cast_vectors.emplace_back(cast_type, count);
+		VectorOperations::Cast(context, chunk.data[col], cast_vectors.back(), count);
+		Vector::RecursiveToUnifiedFormat(cast_vectors.back(), count, formats[col]);
+	}
+
+	local_stream.Rewind();
+	for (idx_t i = 0; i < count; i++) {
+		TeeWriteJSONObject(local_stream, row, formats, i);
+		TeeWriteChar(local_stream, '\n');
+	}
+
+	lock_guard<mutex> guard(write_lock);
+	handle->Write(local_stream.GetData(), local_stream.GetPosition());
+}
+
+void TeeNDJSONWriter::Close() {
+	lock_guard<mutex> guard(write_lock);
+	if (handle) {
+		handle->Close();
+		handle.reset();
+	}
+}
+
+} // namespace duckdb
@@ -70,6 +70,22 @@ void SetupPager(const string &out) {
 	FinishPagerDisplay();
 }
 
+// Prints the rendered tee output to the terminal or the pager
+static void PrintTeeOutput(const TeeOptions &options, const string &str_out) {
+	if (options.symbol_flag && !options.pager_flag) {
+		Printer::Print(OutputStream::STREAM_STDOUT, "Tee Operator; Symbol: " + options.symbol);
+	} else if (!options.pager_flag) {
+		Printer::Print(OutputStream::STREAM_STDOUT, options.fingerprint_flag ? "Tee Fingerprint: " : "Tee Operator: ");
+	}
+	if (options.pager_flag) {
+		SetupPager(str_out);
+	} else {
+		Printer::RawPrint(OutputStream::STREAM_STDOUT, str_out);
+	}
+
+	Printer::Flush(OutputStream::STREAM_STDOUT);
+}
+
 PhysicalTee::PhysicalTee(PhysicalPlan &physical_plan, vector<LogicalType> types_p, vector<string> names_p,
                          idx_t estimated_cardinality, idx_t projected_input_count_p,
                          named_parameter_map_t tee_named_parameters_p)
@@ -93,10 +109,23 @@ InsertionOrderPreservingMap<string> PhysicalTee::ParamsToString() const {
 	}
 	if (options.path_flag) {
 		out["path"] = options.path;
+		out["format"] = options.format;
+	}
+	if (options.append_flag) {
+		out["mode"] = "append";
 	}
 	if (options.table_name_flag) {
 		out["table_name"] = options.table_name;
 	}
+	if (options.group_commit_flag) {
+		out["group_commit"] = "active";
+	}
+	if (options.fingerprint_flag) {
+		out["fingerprint"] = "active";
+	}
+	if (options.compress_flag && options.NeedsBuffer()) {
+		out["compress"] = "active";
+	}
 	// maxrows is always shown
 	if (options.max_rows == NumericLimits<idx_t>::Maximum()) {
 		out["maxrows"] = "all";
@@ -110,22 +139,37 @@ InsertionOrderPreservingMap<string> PhysicalTee::ParamsToString() const {
 TeeLocalState::TeeLocalState(ClientContext &context, const TeeOptions &options, const vector<LogicalType> &tee_types,
                              shared_ptr<TeeGlobalState> global_state_p)
     : global_state(std::move(global_state_p)) {
-	if (options.NeedsBuffer()) {
+	if (options.NeedsBuffer() && options.compress_flag && TeeCompressedBuffer::SupportsTypes(tee_types)) {
+		local_compressed = make_uniq<TeeCompressedBuffer>(context, tee_types);
+	} else if (options.NeedsBuffer()) {
 		local_buffer = make_uniq<ColumnDataCollection>(context, tee_types);
 		local_buffer->InitializeAppend(local_append_state);
 	}
-	if (options.path_flag) {
-		vector<LogicalType> varchar_types(tee_types.size(), LogicalType::VARCHAR);
-		varchar_chunk_csv.Initialize(context, varchar_types);
+	if (options.IsNativeFormat()) {
+		local_native_stream = make_uniq<MemoryStream>();
+	} else if (options.path_flag) {
+		if (!options.IsNDJSONFormat()) {
+			vector<LogicalType> varchar_types(tee_types.size(), LogicalType::VARCHAR);
+			varchar_chunk_csv.Initialize(context, varchar_types);
+		}
 		// in csv_writer.hpp they used: idx_t flush_size = 4096ULL * 8ULL;
 		local_csv_state = make_uniq<CSVWriterState>(context, 4096ULL * 8ULL);
 	}
+	if (options.fingerprint_flag) {
+		local_fingerprint = make_uniq<TeeFingerprint>(tee_types.size());
+	}
 }
 
 void TeeLocalState::Finalize(const PhysicalOperator &op, ExecutionContext &context) {
 	if (local_buffer) {
 		global_state->AppendLocalToGlobalBuffer(*local_buffer);
 	}
+	if (local_compressed) {
+		global_state->AppendLocalToGlobalCompressed(*local_compressed);
+	}
+	if (local_fingerprint) {
+		global_state->CombineFingerprint(*local_fingerprint);
+	}
 }
 
 void TeeLocalState::Reset() {
@@ -133,9 +177,15 @@ void TeeLocalState::Reset() {
 		local_buffer->Reset();
 		local_buffer->InitializeAppend(local_append_state);
 	}
+	if (local_compressed) {
+		local_compressed->Reset();
+	}
 	if (local_csv_state) {
 		local_csv_state->Reset();
 	}
+	if (local_fingerprint) {
+		local_fingerprint->Reset();
+	}
 }
 
 unique_ptr<OperatorState> PhysicalTee::GetOperatorState(ExecutionContext &context) const {
@@ -164,6 +214,13 @@ OperatorResultType PhysicalTee::Execute(ExecutionContext &context, DataChunk &in
 	if (l_state.local_buffer) {
 		l_state.local_buffer->Append(l_state.local_append_state, *tee_chunk);
 	}
+	if (l_state.local_compressed) {
+		l_state.local_compressed->Append(*tee_chunk);
+	}
+	// Fingerprint
+	if (l_state.local_fingerprint) {
+		l_state.local_fingerprint->Update(*tee_chunk);
+	}
 	// Stream
 	if (options.NeedsStream()) {
 		l_state.global_state->WriteChunk(context.client, *tee_chunk, l_state);
@@ -175,98 +232,97 @@ OperatorResultType PhysicalTee::Execute(ExecutionContext &context, DataChunk &in
 // Opens every streamed target once, they stay open until QueryEnd
 TeeGlobalState::TeeGlobalState(ClientContext &context, const TeeOptions &options, const vector<string> &names,
                                const vector<LogicalType> &types, string key_p)
-    : key(std::move(key_p)) {
-	if (options.NeedsBuffer()) {
+    : cached_sinks(options.append_flag), group_commit(options.group_commit_flag), key(std::move(key_p)) {
+	if (options.NeedsBuffer() && options.compress_flag && TeeCompressedBuffer::SupportsTypes(types)) {
+		compressed = make_uniq<TeeCompressedBuffer>(context, types);
+	} else if (options.NeedsBuffer()) {
 		buffered = make_uniq<ColumnDataCollection>(context, types);
 	}
-	if (options.path_flag) {
-		TeeInitializeCSVWriter(context, options, names);
+	// append-mode sinks come from the connection, so repeated executions reuse them
+	shared_ptr<TeeSinkCache> sink_cache;
+	if (cached_sinks) {
+		sink_cache = context.registered_state->GetOrCreate<TeeSinkCache>(TeeSinkCache::KEY);
+	}
+	if (options.path_flag && sink_cache) {
+		file_sink = sink_cache->GetFileSink(context, options, names, types);
+	} else if (options.path_flag) {
+		// the file is replaced, append writers for it would continue from stale offsets,
+		// the cached one of this connection and the native one every connection shares
+		auto existing_cache = context.registered_state->Get<TeeSinkCache>(TeeSinkCache::KEY);
+		if (existing_cache) {
+			existing_cache->Evict(options.path);
+		}
+		TeeNativeAppendWriters::Get(context)->Invalidate(context, options.path);
+		file_sink = make_shared_ptr<TeeFileSink>(context, options, names, types);
 	}
 	if (options.table_name_flag) {
-		TeeInitializeTableWriter(context, options, names, types);
+		// a fingerprint is stored instead of the rows
+		auto table_names = options.fingerprint_flag ? TeeFingerprint::TableNames() : names;
+		auto table_types = options.fingerprint_flag ? TeeFingerprint::TableTypes() : types;
+		if (group_commit) {
+			table_sink = make_shared_ptr<TeeGroupCommitSink>(context, options, table_names, table_types);
+		} else {
+			auto table_name = TeeTableSink::BindName(context, options.table_name);
+			table_sink = make_shared_ptr<TeeTableSink>(context, table_name, table_names, table_types);
+		}
+		Printer::Print(OutputStream::STREAM_STDOUT,
+		               "Table " + options.table_name + " created and added to the current attached database. ");
+	}
+	if (options.fingerprint_flag) {
+		fingerprint = make_uniq<TeeFingerprint>(types.size());
 	}
 	Printer::Flush(OutputStream::STREAM_STDOUT);
 }
 
-void TeeGlobalState::TeeInitializeCSVWriter(ClientContext &context, const TeeOptions &options,
-                                            const vector<string> &names) {
-	Printer::Print(OutputStream::STREAM_STDOUT, "Write to: " + options.path);
-	FileSystem &fs = FileSystem::GetFileSystem(context);
-
-	// prepare options
-	CSVReaderOptions csv_options;
-	csv_options.name_list = names;
-	// set own names
-	csv_options.columns_set = true;
-	csv_options.force_quote.resize(names.size(), false);
-
-	csv_writer = make_uniq<CSVWriter>(csv_options, fs, options.path, FileCompressionType::UNCOMPRESSED);
-	// force writing header and prefix
-	csv_writer->Initialize(true);
-}
-
-void TeeGlobalState::TeeInitializeTableWriter(ClientContext &context, const TeeOptions &options,
-                                              const vector<string> &names, const vector<LogicalType> &types) {
-	auto &db = context.db->GetDatabase(context);
-	con = make_uniq<Connection>(db);
-
-	// copy the name and type schema of the current subquery for the new table
-	string name_types = "";
-	for (idx_t i = 0; i < names.size(); i++) {
-		name_types += " " + names[i] + " " + types[i].ToString();
-		if (i + 1 < names.size()) {
-			name_types += ", ";
-		};
-	}
-	con->Query("CREATE TABLE IF NOT EXISTS " + options.table_name + "(" + name_types + ")");
-
-	// create an appender on the existing context
-	// is responsible for writing the actual rows in the table
-	appender = make_uniq<Appender>(*con, Identifier(options.table_name));
-	Printer::Print(OutputStream::STREAM_STDOUT,
-	               "Table " + options.table_name + " created and added to the current attached database. ");
-}
-
 void TeeGlobalState::QueryEnd(ClientContext &context, optional_ptr<ErrorData> error) {
-	if (appender) {
-		appender->Close();
-		appender.reset();
+	// a cached sink the cache already let go of is closed by its last user
+	if (file_sink && cached_sinks && file_sink.use_count() > 1) {
+		file_sink->Flush();
+	} else if (file_sink) {
+		file_sink->Close();
 	}
-	if (csv_writer) {
-		csv_writer->Close();
-		csv_writer.reset();
+	if (table_sink) {
+		table_sink->Close();
 	}
+	file_sink.reset();
+	table_sink.reset();
 
 	context.registered_state->Remove(key);
 }
 
 void TeeGlobalState::WriteChunk(ClientContext &context, DataChunk &chunk, TeeLocalState &l_state) {
-	idx_t rows = chunk.size();
-	if (rows == 0) {
+	if (chunk.size() == 0) {
 		return;
 	}
-	if (csv_writer) {
-		auto &varchar_chunk = l_state.varchar_chunk_csv;
-		varchar_chunk.Reset();
-		for (idx_t col = 0; col < chunk.ColumnCount(); col++) {
-			VectorOperations::Cast(context, chunk.data[col], varchar_chunk.data[col], rows);
-		}
-		varchar_chunk.SetChildCardinality(rows);
-
-		csv_writer->WriteChunk(varchar_chunk, *l_state.local_csv_state);
-		csv_writer->Flush(*l_state.local_csv_state);
+	if (file_sink) {
+		file_sink->WriteChunk(context, chunk, l_state);
+	}
+	if (table_sink) {
+		table_sink->WriteChunk(context, chunk, l_state);
 	}
+}
 
-	if (appender) {
-		lock_guard<mutex> guard(appender_lock);
-		appender->AppendDataChunk(chunk);
+void TeeGlobalState::WriteFingerprint(const vector<string> &names) {
+	if (!table_sink) {
+		return;
+	}
+	DataChunk fingerprint_chunk;
+	fingerprint_chunk.Initialize(Allocator::DefaultAllocator(), TeeFingerprint::TableTypes());
+	// wide results have more columns than fit in one chunk
+	for (idx_t offset = 0; offset < fingerprint->TableRowCount(); offset += STANDARD_VECTOR_SIZE) {
+		fingerprint_chunk.Reset();
+		fingerprint->ToChunk(names, offset, fingerprint_chunk);
+		if (group_commit) {
+			table_sink->Cast<TeeGroupCommitSink>().AppendChunk(fingerprint_chunk);
+		} else {
+			table_sink->Cast<TeeTableSink>().AppendChunk(fingerprint_chunk);
+		}
 	}
 }
 
 void TeeGlobalState::Flush() {
-	if (appender) {
-		lock_guard<mutex> guard(appender_lock);
-		appender->Flush();
+	if (table_sink) {
+		table_sink->Flush();
 	}
 }
 
@@ -274,31 +330,32 @@ OperatorFinalResultType PhysicalTee::OperatorFinalize(Pipeline &pipeline, Event
                                                       OperatorFinalizeInput &input) const {
 	auto tee_state = context.registered_state->Get<TeeGlobalState>(StateKey());
 
+	if (options.fingerprint_flag) {
+		tee_state->WriteFingerprint(names_output);
+	}
 	tee_state->Flush();
 
+	if (options.fingerprint_flag && (options.terminal_flag || options.pager_flag)) {
+		PrintTeeOutput(options, tee_state->fingerprint->ToString(names_output));
+		return OperatorFinalResultType::FINISHED;
+	}
 	if (!options.NeedsBuffer()) {
 		return OperatorFinalResultType::FINISHED;
 	}
-
-	ColumnDataCollectionWrapper render_buffer(*tee_state->buffered);
 	ClientBoxRendererContext render_context(context);
 	BoxRendererConfig config;
 	config.max_rows = options.max_rows;
 	BoxRenderer renderer(config);
-	string str_out = renderer.ToString(render_context, names_output, render_buffer);
-
-	if (options.symbol_flag && !options.pager_flag) {
-		Printer::Print(OutputStream::STREAM_STDOUT, "Tee Operator; Symbol: " + options.symbol);
-	} else if (!options.pager_flag) {
-		Printer::Print(OutputStream::STREAM_STDOUT, "Tee Operator: ");
-	}
-	if (options.pager_flag) {
-		SetupPager(str_out);
+	string str_out;
+	if (tee_state->compressed) {
+		// only the chunks the renderer fetches are decoded
+		TeeCompressedRenderWrapper render_buffer(*tee_state->compressed);
+		str_out = renderer.ToString(render_context, names_output, render_buffer);
 	} else {
-		Printer::RawPrint(OutputStream::STREAM_STDOUT, str_out);
+		ColumnDataCollectionWrapper render_buffer(*tee_state->buffered);
+		str_out = renderer.ToString(render_context, names_output, render_buffer);
 	}
-
-	Printer::Flush(OutputStream::STREAM_STDOUT);
+	PrintTeeOutput(options, str_out);
 
 	return OperatorFinalResultType::FINISHED;
 }
@@ -0,0 +1,349 @@
+#include "include/tee_extension.hpp"
+#include "duckdb/common/csv_writer.hpp"
+#include "duckdb/common/printer.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include "duckdb/catalog/catalog.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/catalog/catalog_search_path.hpp"
+#include "duckdb/execution/operator/csv_scanner/csv_reader_options.hpp"
+#include "duckdb/main/client_data.hpp"
+#include "duckdb/main/database_manager.hpp"
+#include "duckdb/parser/parsed_data/create_table_info.hpp"
+#include "duckdb/planner/binder.hpp"
+#include "duckdb/planner/constraints/bound_constraint.hpp"
+#include "duckdb/storage/data_table.hpp"
+#include "duckdb/storage/table/append_state.hpp"
+
+namespace duckdb {
+
+// Lets the CSVWriter append to a file it did not open itself
+class TeeFileWriteStream : public WriteStream {
+public:
+	explicit TeeFileWriteStream(FileHandle &handle) : handle(handle) {
+	}
+
+	void WriteData(const_data_ptr_t buffer, idx_t write_size) override {
+		handle.Write(const_cast<data_ptr_t>(buffer), write_size);
+	}
+
+private:
+	FileHandle &handle;
+};
+
+TeeFileSink::TeeFileSink(ClientContext &context, const TeeOptions &options, const vector<string> &names,
+                         const vector<LogicalType> &types)
+    : TeeSink(names, types) {
+	if (options.IsNativeFormat() && options.append_flag) {
+		native_writer = TeeNativeAppendWriters::Get(context)->GetWriter(context, options.path, names, types);
+		shared_native_writer = true;
+	} else if (options.IsNativeFormat()) {
+		native_writer = make_shared_ptr<TeeNativeWriter>(context, options.path, names, types, false);
+	} else if (options.IsNDJSONFormat()) {
+		ndjson_writer = make_uniq<TeeNDJSONWriter>(context, options.path, names, types, options.append_flag);
+	} else {
+		TeeInitializeCSVWriter(context, options);
+	}
+}
+
+void TeeFileSink::TeeInitializeCSVWriter(ClientContext &context, const TeeOptions &options) {
+	Printer::Print(OutputStream::STREAM_STDOUT, "Write to: " + options.path);
+	FileSystem &fs = FileSystem::GetFileSystem(context);
+
+	if (options.append_flag) {
+		// keep what is there, the header is only written into an empty file
+		csv_handle = fs.OpenFile(options.path, FileFlags::FILE_FLAGS_WRITE | FileFlags::FILE_FLAGS_FILE_CREATE |
+		                                           FileFlags::FILE_FLAGS_APPEND);
+		csv_stream = make_uniq<TeeFileWriteStream>(*csv_handle);
+		csv_writer = make_uniq<CSVWriter>(*csv_stream, names);
+		if (csv_handle->GetFileSize() == 0) {
+			csv_writer->Initialize(true);
+		}
+		return;
+	}
+
+	// prepare options
+	CSVReaderOptions csv_options;
+	csv_options.name_list = names;
+	// set own names
+	csv_options.columns_set = true;
+	csv_options.force_quote.resize(names.size(), false);
+
+	csv_writer = make_uniq<CSVWriter>(csv_options, fs, options.path, FileCompressionType::UNCOMPRESSED);
+	// force writing header and prefix
+	csv_writer->Initialize(true);
+}
+
+void TeeFileSink::WriteChunk(ClientContext &context, DataChunk &chunk, TeeLocalState &l_state) {
+	idx_t rows = chunk.size();
+	if (native_writer) {
+		native_writer->WriteChunk(chunk, *l_state.local_native_stream);
+		return;
+	}
+	if (ndjson_writer) {
+		// json lines are encoded into the same thread-local buffer the csv writer uses
+		ndjson_writer->WriteChunk(context, chunk, *l_state.local_csv_state->stream);
+		return;
+	}
+
+	auto &varchar_chunk = l_state.varchar_chunk_csv;
+	varchar_chunk.Reset();
+	for (idx_t col = 0; col < chunk.ColumnCount(); col++) {
+		VectorOperations::Cast(context, chunk.data[col], varchar_chunk.data[col], rows);
+	}
+	varchar_chunk.SetChildCardinality(rows);
+
+	csv_writer->WriteChunk(varchar_chunk, *l_state.local_csv_state);
+	csv_writer->Flush(*l_state.local_csv_state);
+}
+
+void TeeFileSink::Flush() {
+	// csv chunks are flushed as they are written, a native file needs its footer
+	if (native_writer) {
+		native_writer->Flush();
+	}
+}
+
+void TeeFileSink::Close() {
+	if (csv_writer) {
+		csv_writer->Close();
+		csv_writer.reset();
+	}
+	if (csv_handle) {
+		csv_handle->Close();
+		csv_handle.reset();
+	}
+	if (native_writer && !shared_native_writer) {
+		native_writer->Close();
+	}
+	native_writer.reset();
+	if (ndjson_writer) {
+		ndjson_writer->Close();
+		ndjson_writer.reset();
+	}
+}
+
+QualifiedName TeeTableSink::BindName(ClientContext &context, const string &table_name) {
+	auto qualified_name = QualifiedName::Parse(table_name);
+	Binder::BindSchemaOrCatalog(context, qualified_name.catalog, qualified_name.schema);
+	return qualified_name;
+}
+
+TableCatalogEntry &TeeTableSink::CreateTable(ClientContext &context, const QualifiedName &table_name,
+                                             const vector<string> &names, const vector<LogicalType> &types) {
+	// the bound types are used as they are, nothing is printed and parsed again
+	auto info = make_uniq<CreateTableInfo>(table_name.catalog, table_name.schema, table_name.name);
+	for (idx_t i = 0; i < names.size(); i++) {
+		info->columns.AddColumn(ColumnDefinition(names[i], types[i]));
+	}
+	info->on_conflict = OnCreateConflict::IGNORE_ON_CONFLICT;
+	auto &catalog = Catalog::GetCatalog(context, table_name.catalog);
+	catalog.CreateTable(context, std::move(info));
+
+	auto &table =
+	    Catalog::GetEntry<TableCatalogEntry>(context, table_name.catalog, table_name.schema, table_name.name);
+	if (!table.IsDuckTable()) {
+		throw NotImplementedException("Tee: table_name only supports tables of DuckDB databases");
+	}
+	return table;
+}
+
+TeeTableSink::TeeTableSink(ClientContext &context_p, const QualifiedName &table_name, const vector<string> &names,
+                           const vector<LogicalType> &types)
+    : TeeSink(names, types), context(context_p) {
+	table = CreateTable(context, table_name, names, types);
+	table_types = table->GetTypes();
+	if (table_types.size() != types.size()) {
+		throw InvalidInputException("Tee: table %s has %d columns, but the tee produces %d", table_name.name,
+		                            table_types.size(), types.size());
+	}
+	if (table_types != types) {
+		cast_chunk.Initialize(Allocator::Get(context), table_types);
+	}
+	auto binder = Binder::CreateBinder(context);
+	bound_constraints = binder->BindConstraints(*table);
+}
+
+TeeTableSink::~TeeTableSink() {
+}
+
+void TeeTableSink::WriteChunk(ClientContext &context, DataChunk &chunk, TeeLocalState &l_state) {
+	AppendChunk(chunk);
+}
+
+void TeeTableSink::AppendChunk(DataChunk &chunk) {
+	lock_guard<mutex> guard(append_lock);
+	auto &storage = table->GetStorage();
+	if (!append_state) {
+		append_state = make_uniq<LocalAppendState>();
+		storage.InitializeLocalAppend(*append_state, *table, context, bound_constraints);
+	}
+	// an existing table decides the types, like an INSERT would
+	if (cast_chunk.ColumnCount() > 0) {
+		cast_chunk.Reset();
+		for (idx_t col = 0; col < chunk.ColumnCount(); col++) {
+			if (chunk.data[col].GetType() == table_types[col]) {
+				cast_chunk.data[col].Reference(chunk.data[col]);
+			} else {
+				VectorOperations::Cast(context, chunk.data[col], cast_chunk.data[col], chunk.size());
+			}
+		}
+		cast_chunk.SetCardinality(chunk.size());
+		storage.LocalAppend(*append_state, context, cast_chunk, false);
+		return;
+	}
+	storage.LocalAppend(*append_state, context, chunk, false);
+}
+
+void TeeTableSink::Flush() {
+	lock_guard<mutex> guard(append_lock);
+	if (append_state) {
+		table->GetStorage().FinalizeLocalAppend(*append_state);
+		append_state.reset();
+	}
+}
+
+void TeeTableSink::Close() {
+	lock_guard<mutex> guard(append_lock);
+	append_state.reset();
+}
+
+// where CREATE TABLE in this session would put a table without catalog or schema
+static void TeeDefaultTableLocation(ClientContext &context, QualifiedName &table_name) {
+	auto default_entry = ClientData::Get(context).catalog_search_path->GetDefault();
+	if (table_name.catalog.empty()) {
+		table_name.catalog = DatabaseManager::GetDefaultDatabase(context);
+	}
+	if (table_name.schema.empty()) {
+		auto in_default = default_entry.catalog.empty() || default_entry.catalog == table_name.catalog;
+		table_name.schema = in_default && !default_entry.schema.empty() ? default_entry.schema : DEFAULT_SCHEMA;
+	}
+}
+
+TeeGroupCommitSink::TeeGroupCommitSink(ClientContext &context, const TeeOptions &options, const vector<string> &names,
+                                       const vector<LogicalType> &types)
+    : TeeSink(names, types), max_rows(10000), max_wait(10) {
+	Value setting;
+	if (context.TryGetCurrentSetting("tee_group_commit_max_rows", setting)) {
+		max_rows = setting.GetValue<idx_t>();
+	}
+	if (context.TryGetCurrentSetting("tee_group_commit_max_wait_ms", setting)) {
+		max_wait = std::chrono::milliseconds(setting.GetValue<idx_t>());
+	}
+
+	// the writer commits on its own connection, so the name is resolved with USE and
+	// search_path of this session and the writer is shared per fully qualified table
+	auto table_name = TeeTableSink::BindName(context, options.table_name);
+	auto existing = Catalog::GetEntry<TableCatalogEntry>(context, table_name.catalog, table_name.schema,
+	                                                     table_name.name, OnEntryNotFound::RETURN_NULL);
+	if (existing) {
+		// every group checks the table again, this only keeps a mismatching query out of one
+		if (existing->GetTypes().size() != types.size()) {
+			throw InvalidInputException("Tee: table %s has %d columns, but the tee produces %d", table_name.name,
+			                            existing->GetTypes().size(), types.size());
+		}
+		table_name.catalog = existing->ParentCatalog().GetName();
+		table_name.schema = existing->ParentSchema().name;
+	} else {
+		TeeDefaultTableLocation(context, table_name);
+	}
+	writer = TeeGroupCommitWriter::Get(context, table_name);
+	// the table sink of the group casts to the types of the table
+	rows = make_uniq<ColumnDataCollection>(Allocator::DefaultAllocator(), types);
+}
+
+void TeeGroupCommitSink::WriteChunk(ClientContext &context, DataChunk &chunk, TeeLocalState &l_state) {
+	AppendChunk(chunk);
+}
+
+void TeeGroupCommitSink::AppendChunk(DataChunk &chunk) {
+	lock_guard<mutex> guard(rows_lock);
+	rows->Append(chunk);
+}
+
+void TeeGroupCommitSink::Flush() {
+	unique_ptr<ColumnDataCollection> query_rows;
+	{
+		lock_guard<mutex> guard(rows_lock);
+		if (!rows || rows->Count() == 0) {
+			return;
+		}
+		query_rows = std::move(rows);
+	}
+	writer->Commit(names, std::move(query_rows), max_rows, max_wait);
+}
+
+void TeeGroupCommitSink::Close() {
+	lock_guard<mutex> guard(rows_lock);
+	rows.reset();
+	writer.reset();
+}
+
+// sinks still held by a running query are never closed here
+static void TeeCloseUnused(shared_ptr<TeeSink> &sink) {
+	if (sink.use_count() == 1) {
+		sink->Close();
+	}
+}
+
+shared_ptr<TeeSink> TeeSinkCache::GetFileSink(ClientContext &context, const TeeOptions &options,
+                                              const vector<string> &names, const vector<LogicalType> &types) {
+	lock_guard<mutex> guard(cache_lock);
+	CloseIdle(context);
+	auto entry = sinks.find(options.path);
+	if (entry != sinks.end()) {
+		auto stale = entry->second.sink->Cast<TeeFileSink>().IsStale();
+		if (!stale && entry->second.format == options.format && entry->second.sink->Matches(names, types)) {
+			entry->second.last_used = time(nullptr);
+			return entry->second.sink;
+		}
+		// the query changed its format or schema, or the file was overwritten, start over with a fresh target
+		TeeCloseUnused(entry->second.sink);
+		sinks.erase(entry);
+	}
+	shared_ptr<TeeSink> sink = make_shared_ptr<TeeFileSink>(context, options, names, types);
+	sinks[options.path] = CachedSink {sink, options.format, time(nullptr)};
+	return sink;
+}
+
+void TeeSinkCache::Evict(const string &path) {
+	lock_guard<mutex> guard(cache_lock);
+	auto entry = sinks.find(path);
+	if (entry != sinks.end()) {
+		TeeCloseUnused(entry->second.sink);
+		sinks.erase(entry);
+	}
+}
+
+void TeeSinkCache::CloseIdle(ClientContext &context) {
+	Value timeout_value;
+	idx_t timeout = 60;
+	if (context.TryGetCurrentSetting("tee_sink_idle_timeout", timeout_value)) {
+		timeout = timeout_value.GetValue<idx_t>();
+	}
+	auto now = time(nullptr);
+	for (auto entry = sinks.begin(); entry != sinks.end();) {
+		if (entry->second.sink.use_count() == 1 && static_cast<idx_t>(now - entry->second.last_used) >= timeout) {
+			entry->second.sink->Close();
+			entry = sinks.erase(entry);
+		} else {
+			entry++;
+		}
+	}
+}
+
+void TeeSinkCache::QueryEnd(ClientContext &context, optional_ptr<ErrorData> error) {
+	lock_guard<mutex> guard(cache_lock);
+	CloseIdle(context);
+}
+
+TeeSinkCache::~TeeSinkCache() {
+	for (auto &entry : sinks) {
+		try {
+			entry.second.sink->Close();
+		} catch (std::exception &ex) {
+			// the connection is going away, there is nobody left to report to
+		}
+	}
+}
+
+} // namespace duckdb
@@ -0,0 +1,58 @@
+import pytest
+import subprocess
+import os
+
+DUCKDB = os.path.expanduser("~/tee_operator/build/debug/duckdb")
+
+# constant, run-length, dictionary with NULL and plain segments, and values that are equal
+# in SQL but render differently: intervals of a month and of 30 days, 0.0 and -0.0, NaN
+SEGMENTS_QUERY = """
+SELECT 'constant' AS c,
+       i // 500 AS r,
+       CASE WHEN i % 11 = 0 THEN NULL ELSE 'event_' || (i % 5)::VARCHAR END AS d,
+       i AS p,
+       'a_long_string_that_is_not_inlined_' || (i % 3)::VARCHAR AS s,
+       CASE WHEN i % 2 = 0 THEN INTERVAL '1 month' ELSE INTERVAL '30 days' END AS iv,
+       CASE WHEN i % 2 = 0 THEN '0.0'::DOUBLE ELSE '-0.0'::DOUBLE END AS z,
+       CASE WHEN i % 3 = 0 THEN 'nan'::DOUBLE ELSE (i % 2)::DOUBLE END AS n
+FROM range(10000) t(i)
+"""
+
+# nested columns are captured uncompressed
+NESTED_QUERY = "SELECT i, [i, i + 1] AS l FROM range(3000) t(i)"
+
+EMPTY_QUERY = "SELECT * FROM range(0)"
+
+def render_tee(query, compress, maxrows):
+    # one thread, so the captured chunks keep their order
+    sql = f"""
+    SET threads = 1;
+    SELECT count(*) FROM tee(({query}), compress = {compress}, maxrows = {maxrows});
+    """
+
+    result = subprocess.run(
+        [DUCKDB, "-c", sql],
+        text=True,
+        capture_output=True,
+        check=True
+    )
+
+    print("STDERR:", result.stderr)
+    assert result.returncode == 0
+    return result.stdout
+
+@pytest.mark.parametrize("maxrows", [0, 40])
+def test_compressed_render_matches(maxrows):
+    plain = render_tee(SEGMENTS_QUERY, "false", maxrows)
+    compressed = render_tee(SEGMENTS_QUERY, "true", maxrows)
+
+    # the rendered rows come from the buffer, the count from the pass-through rows
+    assert "event_1" in compressed
+    assert "NULL" in compressed
+    assert "30 days" in compressed
+    assert "-0.0" in compressed
+    assert compressed == plain
+
+@pytest.mark.parametrize("query", [NESTED_QUERY, EMPTY_QUERY])
+def test_uncompressed_render_matches(query):
+    assert render_tee(query, "true", 40) == render_tee(query, "false", 40)
@@ -0,0 +1,26 @@
+import pytest
+import subprocess
+import os
+
+DUCKDB = os.path.expanduser("~/tee_operator/build/debug/duckdb")
+
+# more columns than fit in one chunk of fingerprint rows
+WIDE_COLUMNS = 3000
+
+def test_wide_fingerprint_table():
+    columns = ", ".join(f"i + {col} AS c{col}" for col in range(WIDE_COLUMNS))
+    sql = f"""
+    SELECT count(*) FROM tee((SELECT {columns} FROM range(3) t(i)), fingerprint = true, table_name = 'fp_wide', terminal = false);
+    SELECT count(*), count(column_name), min(row_count), max(row_count) FROM fp_wide;
+    """
+
+    result = subprocess.run(
+        [DUCKDB, "-csv", "-noheader", "-c", sql],
+        text=True,
+        capture_output=True
+    )
+
+    print("STDERR:", result.stderr)
+    assert result.returncode == 0
+    lines = result.stdout.splitlines()
+    assert lines[-1] == f"{WIDE_COLUMNS + 1},{WIDE_COLUMNS},3,3"
@@ -0,0 +1,74 @@
+import pytest
+import subprocess
+import os
+import shutil
+import struct
+
+DUCKDB = os.path.expanduser("~/tee_operator/build/debug/duckdb")
+
+# one VARCHAR row: header at 0, validity at 64, offsets at 128, heap at 192, footer at 256
+OFFSETS_POSITION = 128
+
+@pytest.fixture
+def workdir(tmp_path):
+    base_dir = tmp_path / "native_files_testing"
+    base_dir.mkdir()
+
+    old_cwd = os.getcwd()
+    os.chdir(base_dir)
+
+    yield base_dir
+
+    # Delete the generated files
+    os.chdir(old_cwd)
+    shutil.rmtree(base_dir, ignore_errors=True)
+
+def run_duckdb(sql):
+    return subprocess.run(
+        [DUCKDB, "-c", sql],
+        text=True,
+        capture_output=True
+    )
+
+def write_snapshot(workdir):
+    result = run_duckdb("SELECT * FROM tee((SELECT 'abc' AS s), path = 'out.bin', format = 'native', terminal = false);")
+    assert result.returncode == 0
+
+    output_file = workdir / "out.bin"
+    assert output_file.exists()
+    return output_file
+
+def patch_offsets(output_file, first, second):
+    data = bytearray(output_file.read_bytes())
+    struct.pack_into("<QQ", data, OFFSETS_POSITION, first, second)
+    output_file.write_bytes(bytes(data))
+
+def test_read_snapshot(workdir):
+    write_snapshot(workdir)
+
+    result = run_duckdb("SELECT s FROM tee_read('out.bin');")
+    print("STDOUT:", result.stdout)
+    print("STDERR:", result.stderr)
+
+    assert result.returncode == 0
+    assert "abc" in result.stdout
+
+def test_heap_past_the_chunk(workdir):
+    output_file = write_snapshot(workdir)
+    patch_offsets(output_file, 0, 1 << 40)
+
+    result = run_duckdb("SELECT s FROM tee_read('out.bin');")
+    print("STDERR:", result.stderr)
+
+    assert result.returncode != 0
+    assert "exceeds the file" in result.stderr
+
+def test_offsets_not_monotonic(workdir):
+    output_file = write_snapshot(workdir)
+    patch_offsets(output_file, 2, 1)
+
+    result = run_duckdb("SELECT s FROM tee_read('out.bin');")
+    print("STDERR:", result.stderr)
+
+    assert result.returncode != 0
+    assert "corrupt string offsets" in result.stderr